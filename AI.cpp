@@ -1,111 +1,583 @@
 #include "AI.hpp"
+#include "Pattern.hpp"
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <thread>
 
-AI::AI() : nodesVisited(0), timeOut(false)
+namespace
 {
-    std::memset(history, 0, sizeof(history));
+// 統計ログ (AI のインスタンスをまたいで1つ)
+struct StatsLog
+{
+    std::mutex mutex;
+    std::ofstream out;
+};
+
+StatsLog &statsLog()
+{
+    static StatsLog log;
+    return log;
+}
+} // namespace
+
+AI::AI()
+    : threadCount(Config::SEARCH_THREADS), nodeLimit(0), verbose(true),
+      canonicalTT(Config::TT_CANONICAL), useLmr(true), nodesVisited(0),
+      info(),
+      timeOut(false), stopRequested(false), pondering(false),
+      searchDone(true)
+{
+    if constexpr (STATS_ENABLED)
+    {
+        static std::once_flag envLog;
+        std::call_once(envLog,
+                       []
+                       {
+                           if (const char *path =
+                                   std::getenv("GOMOKU_STATS_LOG"))
+                               openStatsLog(path);
+                       });
+    }
 }
 
-Move AI::getBestMove(Board &board, int maxDepth)
+void AI::newGame()
 {
     tt.clear();
-    std::memset(history, 0, sizeof(history));
-    nodesVisited = 0;
-    timeOut = false;
+    for (auto &t : threads)
+        clearOrdering(t);
+}
+
+void AI::setThreads(int n) { threadCount = std::max(1, n); }
+
+void AI::setTimeLimit(double sec)
+{
+    std::lock_guard<std::mutex> lock(clockMutex);
+    timeManager.setMoveTime(sec);
+}
+
+void AI::setClock(double remainingSec, double incrementSec)
+{
+    std::lock_guard<std::mutex> lock(clockMutex);
+    timeManager.setClock(remainingSec, incrementSec);
+}
+
+void AI::setNodeLimit(long long nodes) { nodeLimit = nodes; }
+
+void AI::setHashSize(size_t mb) { tt.resize(std::max<size_t>(1, mb)); }
+
+bool AI::loadBook(const std::string &path) { return book.open(path); }
+
+void AI::setVerbose(bool v) { verbose = v; }
+
+bool AI::openStatsLog(const std::string &path)
+{
+    if (!STATS_ENABLED)
+        return false;
+    StatsLog &log = statsLog();
+    std::lock_guard<std::mutex> lock(log.mutex);
+    log.out.close();
+    log.out.clear();
+    log.out.open(path, std::ios::app);
+    return (bool)log.out;
+}
+
+void AI::setPondering(bool on)
+{
+    {
+        std::lock_guard<std::mutex> lock(clockMutex);
+        pondering = on;
+        if (on)
+            timeManager.stopClock();
+        else
+            timeManager.startClock(nowNs());
+    }
+    timerCv.notify_all();
+}
+
+Move AI::predictMove(Board &board)
+{
+    TTEntry entry;
+    int sym;
+    if (!tt.probe(ttKey(board, sym), entry) || entry.bestMove.y < 0)
+        return Move();
+    Move m = transformMove(Symmetry::INVERSE[sym], entry.bestMove);
+    if (board.grid[m.y][m.x] != NONE ||
+        (board.currentTurn == BLACK && board.isDoubleThree(m.y, m.x)))
+        return Move();
+    return Move(m.y, m.x);
+}
+
+uint64_t AI::ttKey(const Board &board, int &sym) const
+{
+    if (canonicalTT)
+        return board.canonicalHash(sym);
+    sym = 0;
+    return board.hash;
+}
+
+Move AI::transformMove(int sym, const Move &m)
+{
+    if (sym == 0 || m.y < 0)
+        return m;
+    int c = Symmetry::CELLS[sym][m.y * Config::BOARD_SIZE + m.x];
+    return Move(c / Config::BOARD_SIZE, c % Config::BOARD_SIZE, m.score);
+}
+
+long long AI::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void AI::writeStatsLog(const Board &board) const
+{
+    if constexpr (STATS_ENABLED)
+    {
+        StatsLog &log = statsLog();
+        std::lock_guard<std::mutex> lock(log.mutex);
+        if (!log.out.is_open())
+            return;
+
+        auto rate = [](long long n, long long d)
+        { return d > 0 ? (double)n / d : 0.0; };
+        auto writeStats = [&](std::ostream &os, const SearchStats &st)
+        {
+            os << "\"tt_probes\":" << st.ttProbes
+               << ",\"tt_hit_rate\":" << rate(st.ttHits, st.ttProbes)
+               << ",\"tt_cutoff_rate\":" << rate(st.ttCutoffs, st.ttProbes)
+               << ",\"beta_cutoffs\":" << st.betaCutoffs
+               << ",\"first_move_cutoff_rate\":"
+               << rate(st.cutoffIndex[0], st.betaCutoffs)
+               << ",\"pvs_researches\":" << st.pvsResearches
+               << ",\"aspiration_researches\":" << st.aspirationResearches
+               << ",\"lmr_reductions\":" << st.lmrReductions
+               << ",\"lmr_researches\":" << st.lmrResearches
+               << ",\"cutoff_index\":[";
+            for (int i = 0; i < SearchStats::CUTOFF_SLOTS; ++i)
+                os << (i ? "," : "") << st.cutoffIndex[i];
+            os << "]";
+        };
+
+        // 1探索を1行で書き、行の途中で他のスレッドの出力が混ざらないようにする
+        std::ostringstream os;
+        os << "{\"ply\":" << board.moveCount() << ",\"source\":\""
+           << info.source << "\",\"threads\":" << threadCount
+           << ",\"depth\":" << info.depth
+           << ",\"seldepth\":" << info.selDepth
+           << ",\"nodes\":" << info.nodes
+           << ",\"time_ms\":" << info.timeSec * 1000 << ",\"nps\":"
+           << (info.timeSec > 0 ? info.nodes / info.timeSec : 0.0)
+           << ",\"best\":[" << info.bestMove.x << "," << info.bestMove.y
+           << "],\"score\":" << info.bestMove.score << ",";
+        writeStats(os, info.stats);
+        os << ",\"iterations\":[";
+        for (size_t i = 0; i < info.iterations.size(); ++i)
+        {
+            const SearchInfo::Iteration &it = info.iterations[i];
+            os << (i ? "," : "") << "{\"depth\":" << it.depth
+               << ",\"seldepth\":" << it.selDepth
+               << ",\"nodes\":" << it.nodes
+               << ",\"time_ms\":" << it.timeSec * 1000
+               << ",\"ebf\":" << it.ebf << ",";
+            writeStats(os, it.stats);
+            os << "}";
+        }
+        os << "]}\n";
+        log.out << os.str() << std::flush;
+    }
+    else
+    {
+        (void)board;
+    }
+}
+
+void AI::runTimer()
+{
+    std::unique_lock<std::mutex> lock(clockMutex);
+    while (!searchDone)
+    {
+        long long deadline = timeManager.hardDeadline();
+        long long now = nowNs();
+        if (now >= deadline)
+        {
+            timeOut = true;
+            return;
+        }
+        if (deadline == LLONG_MAX)
+            timerCv.wait(lock);
+        else
+            timerCv.wait_for(lock, std::chrono::nanoseconds(deadline - now));
+    }
+}
+
+Move AI::getBestMove(Board &board, int maxDepth)
+{
+    // TTは手をまたいで保持し、世代だけ進める
+    tt.newSearch();
+    // 開始前に届いた中断要求は requestStop が立てた timeOut ごと残す
+    timeOut = stopRequested.load();
     startTime = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(clockMutex);
+        timeManager.init(board.moveCount());
+        if (!pondering)
+            timeManager.startClock(nowNs());
+    }
+    info = SearchInfo();
+    info.source = "search";
+
+    // 定跡にある局面なら探索しない
+    Move bookMove = book.probe(board);
+    if (bookMove.y >= 0)
+    {
+        nodesVisited = 0;
+        info.source = "book";
+        info.bestMove = bookMove;
+        if (verbose)
+            std::cout << "AI Book move (weight " << bookMove.score << ")"
+                      << std::endl;
+        writeStatsLog(board);
+        return bookMove;
+    }
+
+    // 時間切れ・中断は VCF/VCT の間も timeOut で伝える
+    std::thread timer;
+    {
+        std::lock_guard<std::mutex> lock(clockMutex);
+        searchDone = false;
+        if (timeManager.isLimited())
+            timer = std::thread(&AI::runTimer, this);
+    }
+    auto stopTimer = [&]
+    {
+        {
+            std::lock_guard<std::mutex> lock(clockMutex);
+            searchDone = true;
+        }
+        timerCv.notify_all();
+        if (timer.joinable())
+            timer.join();
+    };
 
-    Move bestMove = {-1, -1};
+    // 四の連続 (VCF) / 四と三 (VCT) で勝ちを読み切れたら全幅探索はしない
+    {
+        Board work = board;
+        ThreatSolver solver(work, &timeOut);
+        Move win;
+        if (solver.solve(false, Config::VCF_MAX_PLIES, Config::VCF_ROOT_NODES,
+                         win) ||
+            solver.solve(true, Config::VCT_MAX_PLIES, Config::VCT_ROOT_NODES,
+                         win))
+        {
+            stopTimer();
+            std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - startTime;
+            nodesVisited = 0;
+            info.source = "threat";
+            info.timeSec = elapsed.count();
+            info.bestMove = win;
+            if (verbose)
+                std::cout << "AI Threat win in " << solver.winPlies()
+                          << " plies" << std::endl;
+            writeStatsLog(board);
+            return win;
+        }
+    }
 
-    for (int depth = 2; depth <= maxDepth; depth += 2)
+    // Lazy SMP: 全スレッドが同じ局面を独立に反復深化し、TTだけを共有する
+    if ((int)threads.size() != threadCount)
+    {
+        threads = std::vector<SearchThread>(threadCount);
+        for (auto &t : threads)
+            clearOrdering(t);
+    }
+    for (int i = 0; i < threadCount; ++i)
     {
-        Move m = minimaxRoot(board, depth);
+        threads[i].id = i;
+        threads[i].board = board;
+        threads[i].board.setSymmetryHashing(canonicalTT);
+        threads[i].rootPly = board.moveCount();
+        ageOrdering(threads[i]);
+        threads[i].nodesVisited = 0;
+        threads[i].stats = SearchStats();
+    }
+
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < threadCount; ++i)
+    {
+        helpers.emplace_back([this, i, maxDepth]
+                             { iterativeDeepening(threads[i], maxDepth); });
+    }
+
+    Move bestMove = iterativeDeepening(threads[0], maxDepth);
+
+    // メインスレッドが終わったら補助スレッドも止める
+    timeOut = true;
+    for (auto &th : helpers)
+        th.join();
+    stopTimer();
+
+    nodesVisited = 0;
+    for (auto &t : threads)
+    {
+        nodesVisited += t.nodesVisited;
+        info.stats.add(t.stats);
+    }
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - startTime;
+    info.nodes = nodesVisited;
+    info.timeSec = elapsed.count();
+    info.selDepth = info.stats.selDepth;
+    info.bestMove = bestMove;
+
+    if (verbose)
+    {
+        std::cout << "AI Depth: " << info.depth;
+        if (STATS_ENABLED)
+            std::cout << "/" << info.selDepth;
+        std::cout << " Nodes: " << nodesVisited
+                  << " Score: " << bestMove.score << std::endl;
+    }
+    writeStatsLog(board);
+    return bestMove;
+}
+
+Move AI::iterativeDeepening(SearchThread &t, int maxDepth)
+{
+    initRootMoves(t);
+    if (t.rootMoves.empty())
+        return {Config::BOARD_SIZE / 2, Config::BOARD_SIZE / 2};
+
+    // 1手目が読み終わる前に時間切れになっても、生成順の先頭の手を返す
+    Move bestMove = t.rootMoves[0].move;
+    bestMove.score = 0;
+    bool hasScore = false;
+    // 評価値は手番側から見た値なので、深さの偶奇で振れる
+    // 窓の中心には同じ偶奇の深さの前の反復の値を使う
+    int parityScore[2] = {0, 0};
+    bool parityKnown[2] = {false, false};
+
+    // 補助スレッドは奇数番が1手深く始め、メインと別の深さを探索する
+    int startDepth = (t.id % 2 == 1) ? 2 : 1;
+
+    for (int depth = startDepth; depth <= maxDepth; ++depth)
+    {
+        // アスピレーション窓: 前の反復の評価値を中心にした狭い窓で探索し、
+        // 外れたら外れた側を広げて探索し直す (勝ち負けが見えていれば全幅)
+        int prev = parityScore[depth % 2];
+        int delta = Config::ASPIRATION_WINDOW;
+        int alpha = -INT_MAX, beta = INT_MAX;
+        if (parityKnown[depth % 2] &&
+            std::abs(prev) < Config::Score::SCORE_WIN - 10000)
+        {
+            alpha = prev - delta;
+            beta = prev + delta;
+        }
+
+        Move m;
+        int searched = 0;
+        while (true)
+        {
+            m = minimaxRoot(t, depth, alpha, beta, searched);
+            if (timeOut)
+                break;
+            bool failLow = m.score <= alpha && alpha != -INT_MAX;
+            bool failHigh = m.score >= beta && beta != INT_MAX;
+            if (!failLow && !failHigh)
+                break;
+
+            t.stats.aspirationResearch();
+            delta *= 4;
+            bool full = delta > Config::Score::SCORE_WIN / 4;
+            if (failLow)
+                alpha = full ? -INT_MAX : prev - delta;
+            else
+                beta = full ? INT_MAX : prev + delta;
+        }
         if (timeOut)
+        {
+            // 途中で打ち切った反復: 読み終えた手の中で alpha を超えた手は
+            // この深さで前の最善手より良いと分かっているので採用する
+            // (窓の下に外れた手は値が上限でしかないので使わない)
+            if (searched > 0 &&
+                (!hasScore || alpha == -INT_MAX || m.score > alpha))
+                bestMove = m;
             break;
+        }
         bestMove = m;
+        hasScore = true;
+        parityScore[depth % 2] = (int)m.score;
+        parityKnown[depth % 2] = true;
+
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = now - startTime;
+        if (t.id == 0)
+        {
+            // 実効分岐数: 直前の反復からのノード数の比を深さの差で均す
+            const auto &its = info.iterations;
+            long long prev = its.empty() ? 0 : its.back().nodes;
+            long long iterNodes = t.nodesVisited - prev;
+            double ebf = std::pow((double)std::max(iterNodes, 1LL),
+                                  1.0 / depth);
+            if (!its.empty())
+            {
+                long long prevIter =
+                    prev - (its.size() > 1 ? its[its.size() - 2].nodes : 0);
+                ebf = std::pow((double)std::max(iterNodes, 1LL) /
+                                   std::max(prevIter, 1LL),
+                               1.0 / (depth - its.back().depth));
+            }
+            info.depth = depth;
+            info.iterations.push_back({depth, t.stats.selDepth,
+                                       t.nodesVisited, elapsed.count(), ebf,
+                                       t.stats});
+        }
 
         // 必勝状態なら早期終了
         if (bestMove.score >= Config::Score::SCORE_WIN - 10000)
             break;
 
-        auto now = std::chrono::steady_clock::now();
-        std::chrono::duration<double> elapsed = now - startTime;
-        if (elapsed.count() > Config::TIME_LIMIT_SEC * 0.6)
+        if (t.id != 0)
+            continue;
+        std::lock_guard<std::mutex> lock(clockMutex);
+        if (timeManager.iterationDone(depth, bestMove, nowNs()))
             break;
     }
-
-    std::cout << "AI Depth: " << maxDepth << " Nodes: " << nodesVisited
-              << " Score: " << bestMove.score << std::endl;
     return bestMove;
 }
 
-Move AI::minimaxRoot(Board &board, int depth)
+void AI::initRootMoves(SearchThread &t)
 {
-    // ルートでは候補手を生成し、高評価順に並べる
-    std::vector<Move> moves = generateMoves(board);
-    if (moves.empty())
-        return {Config::BOARD_SIZE / 2, Config::BOARD_SIZE / 2};
+    Board &board = t.board;
 
-    Move bestMove = moves[0];
-    int alpha = -INT_MAX;
-    int beta = INT_MAX;
+    // ルートでは候補手を高評価順に (ビーム幅まで) 取り出しておく
+    // 前の探索の最善手 (TT手) を先頭にして、PVS の全幅探索をその手に使う
+    TTEntry entry;
+    int sym;
+    Move ttMove;
+    if (tt.probe(ttKey(board, sym), entry))
+        ttMove = transformMove(Symmetry::INVERSE[sym], entry.bestMove);
+    t.rootMoves.clear();
+    MovePicker picker(t.moveStack[0], ttMove, Config::BEAM_WIDTH_ROOT);
+    Move next;
+    while (nextMove(t, picker, next))
+        t.rootMoves.push_back({next, -INT_MAX, 0});
+
+    // 補助スレッドは探索順をずらして別の部分木から埋める
+    size_t n = t.rootMoves.size();
+    if (t.id != 0 && n > 1)
+        std::swap(t.rootMoves[0], t.rootMoves[t.id % n]);
+}
+
+Move AI::minimaxRoot(SearchThread &t, int depth, int alpha, int beta,
+                     int &searched)
+{
+    Board &board = t.board;
+    std::vector<RootMove> &moves = t.rootMoves;
+
+    Move bestMove = moves[0].move;
     int bestScore = -INT_MAX;
+    searched = 0;
 
-    for (auto &m : moves)
+    for (size_t i = 0; i < moves.size(); ++i)
     {
-        auto res = board.makeMove(m.y, m.x);
+        RootMove &rm = moves[i];
+        long long before = t.nodesVisited;
+        board.makeMove(rm.move.y, rm.move.x);
         // 自分の手番で呼び出すので、次は相手(-negamax)
-        int score = -negamax(board, depth - 1, -beta, -alpha);
-        board.undoMove(m.y, m.x, res);
+        int score = pvsChild(t, depth, alpha, beta, i == 0);
+        board.undoMove();
 
         if (timeOut)
-            return bestMove;
+            break;
+        searched++;
+        rm.nodes = t.nodesVisited - before;
+        rm.score = (score > alpha || i == 0) ? score : -INT_MAX;
 
         if (score > bestScore)
         {
             bestScore = score;
-            bestMove = m;
+            bestMove = rm.move;
             bestMove.score = score;
         }
         if (score > alpha)
         {
             alpha = score;
         }
-        // ルートではBetaカットはないが、必勝手が見つかったら終わっても良い
+        // アスピレーション窓の上に外れたら、窓を広げて探索し直す
+        if (alpha >= beta)
+            break;
+        // 必勝手が見つかったら終わっても良い
         if (alpha >= Config::Score::SCORE_WIN - 10000)
             break;
     }
+    if (searched == 0)
+        return bestMove;
+
+    // 次の反復の順序: 最善手を先頭に、値の分かった手を値の順に、
+    // 残りは部分木が大きかった (反証に手間取った) 順に並べる
+    // 読めなかった手は最後の並びのまま後ろに残す
+    std::stable_sort(moves.begin(), moves.begin() + searched,
+                     [](const RootMove &a, const RootMove &b)
+                     {
+                         if (a.score != b.score)
+                             return a.score > b.score;
+                         return a.nodes > b.nodes;
+                     });
+    auto best = std::find_if(moves.begin(), moves.end(),
+                             [&](const RootMove &rm)
+                             { return rm.move == bestMove; });
+    std::rotate(moves.begin(), best, best + 1);
     return bestMove;
 }
 
-int AI::negamax(Board &board, int depth, int alpha, int beta)
+int AI::negamax(SearchThread &t, int depth, int alpha, int beta)
 {
-    nodesVisited++;
-    if ((nodesVisited & 2047) == 0)
+    Board &board = t.board;
+
+    t.nodesVisited++;
+    t.stats.reach(board.moveCount() - t.rootPly);
+    // 時間切れはタイマースレッドが timeOut を立てるので、ここでは時計を見ない
+    if (timeOut.load(std::memory_order_relaxed))
+        return 0;
+    if (stopRequested.load(std::memory_order_relaxed) ||
+        (nodeLimit > 0 && t.nodesVisited >= nodeLimit))
     {
-        auto now = std::chrono::steady_clock::now();
-        std::chrono::duration<double> elapsed = now - startTime;
-        if (elapsed.count() > Config::TIME_LIMIT_SEC)
-        {
-            timeOut = true;
-            return 0;
-        }
+        timeOut = true;
+        return 0;
     }
 
     // 1. TT Lookup
-    if (tt.count(board.hash))
+    TTEntry entry;
+    int sym;
+    uint64_t key = ttKey(board, sym);
+    bool ttHit = tt.probe(key, entry);
+    t.stats.ttProbe(ttHit);
+    if (ttHit)
     {
-        const auto &entry = tt[board.hash];
+        entry.bestMove = transformMove(Symmetry::INVERSE[sym], entry.bestMove);
         if (entry.depth >= depth)
         {
             if (entry.flag == TTFlag::EXACT)
+            {
+                t.stats.ttCutoff();
                 return entry.score;
+            }
             if (entry.flag == TTFlag::LOWERBOUND)
                 alpha = std::max(alpha, entry.score);
             if (entry.flag == TTFlag::UPPERBOUND)
                 beta = std::min(beta, entry.score);
             if (alpha >= beta)
+            {
+                t.stats.ttCutoff();
                 return entry.score;
+            }
         }
     }
 
@@ -121,36 +593,66 @@ int AI::negamax(Board &board, int depth, int alpha, int beta)
         return evaluate(board);
     }
 
-    // 3. 候補手生成
-    std::vector<Move> moves = generateMoves(board);
-    if (moves.empty())
-        return 0; // Draw or No moves
+    // 3. 候補手 (TT手を最優先に、必要になった分だけ生成・選択する)
+    int ply = board.moveCount() - t.rootPly;
+    if (ply >= MAX_PLY)
+        return evaluate(board);
+
+    MovePicker picker(t.moveStack[ply], ttHit ? entry.bestMove : Move(),
+                      beamWidth(depth));
+    Player me = board.currentTurn;
 
-    // TT Move Ordering
-    if (tt.count(board.hash))
+    int originalAlpha = alpha;
+    Move bestMoveInNode = {-1, -1};
+    int maxScore = -INT_MAX;
+
+    // 深さが残っているノードでは、手番側に四/活三を作れる手があれば
+    // VCF を小さな予算で読む (TT手でカットできなかったときの候補手生成の後)
+    bool vcfPending = depth >= 2;
+
+    Move m;
+    while (nextMove(t, picker, m))
     {
-        Move bestTT = tt[board.hash].bestMove;
-        for (auto &m : moves)
+        if (vcfPending && picker.stage == MovePicker::PICK)
         {
-            if (m == bestTT)
+            vcfPending = false;
+            if (picker.attacking)
             {
-                m.score = LLONG_MAX; // 最優先
-                break;
+                ThreatSolver solver(board);
+                Move win;
+                if (solver.solve(false, Config::VCF_MAX_PLIES,
+                                 Config::VCF_SEARCH_NODES, win))
+                {
+                    t.stats.reach(ply + solver.winPlies());
+                    return Config::Score::SCORE_WIN + depth -
+                           solver.winPlies();
+                }
             }
         }
-        std::sort(moves.begin(), moves.end(), [](const Move &a, const Move &b)
-                  { return a.score > b.score; });
-    }
 
-    int originalAlpha = alpha;
-    Move bestMoveInNode = {-1, -1};
-    int maxScore = -INT_MAX;
+        int capturesBefore = board.captures[me];
+        board.makeMove(m.y, m.x);
 
-    for (auto &m : moves)
-    {
-        auto res = board.makeMove(m.y, m.x);
-        int score = -negamax(board, depth - 1, -beta, -alpha);
-        board.undoMove(m.y, m.x, res);
+        // LMR: 四の攻防でも捕獲でもない後半の手は浅く読み、
+        // alpha を超えたときだけ元の深さで読み直す
+        int reduction = 0;
+        if (useLmr && depth >= Config::LMR_MIN_DEPTH &&
+            picker.picked > Config::LMR_MIN_MOVES && !picker.lastForcing &&
+            !picker.threatened && board.captures[me] == capturesBefore)
+            reduction = picker.picked > Config::LMR_LATE_MOVES ? 2 : 1;
+
+        int score;
+        if (reduction > 0)
+        {
+            score = -negamax(t, depth - 1 - reduction, -alpha - 1, -alpha);
+            bool research = score > alpha && !timeOut;
+            t.stats.lmr(research);
+            if (research)
+                score = pvsChild(t, depth, alpha, beta, false);
+        }
+        else
+            score = pvsChild(t, depth, alpha, beta, picker.picked == 1);
+        board.undoMove();
 
         if (timeOut)
             return 0;
@@ -168,28 +670,83 @@ int AI::negamax(Board &board, int depth, int alpha, int beta)
         if (alpha >= beta)
         {
             // Cutoff
-            history[m.y][m.x] += depth * depth;
+            recordCutoff(t, m, depth, ply, !picker.lastForcing);
+            t.stats.betaCutoff(picker.picked - 1);
             break;
         }
     }
+    if (picker.picked == 0)
+        return 0; // Draw or No moves
 
-    TTEntry entry;
-    entry.key = board.hash;
-    entry.depth = depth;
-    entry.score = maxScore;
-    entry.bestMove = bestMoveInNode;
+    TTFlag flag;
     if (maxScore <= originalAlpha)
-        entry.flag = TTFlag::UPPERBOUND;
+        flag = TTFlag::UPPERBOUND;
     else if (maxScore >= beta)
-        entry.flag = TTFlag::LOWERBOUND;
+        flag = TTFlag::LOWERBOUND;
     else
-        entry.flag = TTFlag::EXACT;
+        flag = TTFlag::EXACT;
 
-    tt[board.hash] = entry;
+    tt.store(key, depth, maxScore, flag, transformMove(sym, bestMoveInNode));
 
     return maxScore;
 }
 
+int AI::pvsChild(SearchThread &t, int depth, int alpha, int beta, bool first)
+{
+    if (first)
+        return -negamax(t, depth - 1, -beta, -alpha);
+    // 2手目以降は null window で alpha を超えるかだけを調べ、
+    // 超えたときだけ本来の窓で探索し直す
+    int score = -negamax(t, depth - 1, -alpha - 1, -alpha);
+    if (score > alpha && score < beta && !timeOut)
+    {
+        t.stats.pvsResearch();
+        score = -negamax(t, depth - 1, -beta, -alpha);
+    }
+    return score;
+}
+
+void AI::clearOrdering(SearchThread &t)
+{
+    std::memset(t.history, 0, sizeof(t.history));
+    std::fill(&t.killers[0][0], &t.killers[0][0] + MAX_PLY * 2, Move());
+    std::fill(&t.counterMoves[0][0][0],
+              &t.counterMoves[0][0][0] + 3 * Board::CELL_COUNT, Move());
+}
+
+void AI::ageOrdering(SearchThread &t)
+{
+    // 前の探索の history は弱めて残す (局面が近いので順序はほぼ使える)
+    for (auto &byPlayer : t.history)
+        for (auto &row : byPlayer)
+            for (long long &h : row)
+                h /= Config::HISTORY_AGING;
+    // killer は ply がずれるので引き継がない
+    std::fill(&t.killers[0][0], &t.killers[0][0] + MAX_PLY * 2, Move());
+}
+
+void AI::recordCutoff(SearchThread &t, const Move &m, int depth, int ply,
+                      bool quiet)
+{
+    const Board &board = t.board;
+    t.history[board.currentTurn][m.y][m.x] += depth * depth;
+    // 四の攻防の手はもともと先に読むので、killer / countermove は静かな手だけ
+    if (!quiet)
+        return;
+    Move *killers = t.killers[ply];
+    if (!(killers[0] == m))
+    {
+        killers[1] = killers[0];
+        killers[0] = Move(m.y, m.x);
+    }
+    if (board.moveCount() > 0)
+    {
+        Player prev = (board.currentTurn == BLACK) ? WHITE : BLACK;
+        const Move &last = board.lastMove;
+        t.counterMoves[prev][last.y][last.x] = Move(m.y, m.x);
+    }
+}
+
 // 盤面全体の評価
 int AI::evaluate(Board &board)
 {
@@ -200,182 +757,177 @@ int AI::evaluate(Board &board)
     score += board.captures[me] * Config::Score::SCORE_CAPTURE;
     score -= board.captures[opp] * Config::Score::SCORE_CAPTURE;
 
-    // パターン評価
-    score += evaluatePattern(board, me);
+    // パターン評価 (Board が makeMove/undoMove で差分更新している)
+    score += board.patternScore[me];
     // 相手のパターンは高めに減点（防御重視）
-    score -= evaluatePattern(board, opp) * Config::Score::DEF_BIAS;
+    score -= board.patternScore[opp] * Config::Score::DEF_BIAS;
 
     return score;
 }
 
-// パターン評価（4連、3連など）
-int AI::evaluatePattern(Board &board, Player p)
+// 候補手生成 & 優先度付け
+// 四を作る手と、止めないと次に勝たれる受けの手 (勝ちを含む) を先頭にまとめ、
+// 残りは生成順のまま返す
+int AI::generateMoves(SearchThread &t, Move *out, int &forcingCount,
+                      bool &threatened, bool &attacking)
 {
-    int score = 0;
-    int dy[] = {0, 1, 1, 1};
-    int dx[] = {1, 0, 1, -1};
+    Board &board = t.board;
+    int count = 0;
+    forcingCount = 0;
+    threatened = false;
+    attacking = false;
+
+    // 置いた石を中心とした形ごとの重み (四以上が forcing)
+    static constexpr long long WEIGHT[Pattern::CLASS_COUNT] = {
+        0, 100, 1000, 10000, 100000, 500000, 1000000};
+    // killer / countermove の加点 (静かな手の中では先に読む)
+    static constexpr long long KILLER_BONUS[2] = {300000, 250000};
+    static constexpr long long COUNTER_BONUS = 150000;
 
-    // 高速化のため、石がある場所のみ評価したいが、
-    // 簡易実装として全マス走査する（19x19x4なら十分高速）
-    for (int y = 0; y < Config::BOARD_SIZE; ++y)
-    {
-        for (int x = 0; x < Config::BOARD_SIZE; ++x)
-        {
-            if (board.grid[y][x] != p)
-                continue;
+    Player me = board.currentTurn;
+    Player opp = (me == BLACK ? WHITE : BLACK);
 
-            for (int dir = 0; dir < 4; ++dir)
-            {
-                // 重複カウント防止：逆方向が同じ色ならスキップ（既にカウント済み）
-                if (board.get(y - dy[dir], x - dx[dir]) == p)
-                    continue;
+    int ply = board.moveCount() - t.rootPly;
+    const Move *killers = t.killers[std::min(ply, MAX_PLY - 1)];
+    Move counter;
+    if (board.moveCount() > 0)
+        counter = t.counterMoves[opp][board.lastMove.y][board.lastMove.x];
 
-                int len = 0;
-                int cy = y, cx = x;
-                while (board.get(cy, cx) == p)
-                {
-                    len++;
-                    cy += dy[dir];
-                    cx += dx[dir];
-                }
+    // Board が差分管理している候補手集合 (石の近傍2マス以内の空点) を使う
+    // 三三禁のチェックは選択時まで遅らせる
+    board.forEachCandidate([&](int ny, int nx) { out[count++] = Move(ny, nx); });
 
-                bool openHead = (board.get(y - dy[dir], x - dx[dir]) == NONE);
-                bool openTail = (board.get(cy, cx) == NONE);
+    for (int i = 0; i < count; ++i)
+    {
+        int ny = out[i].y, nx = out[i].x;
+        // 置いた石を中心とした形 [0, 4) が自分、[4, 8) が相手の4方向
+        uint8_t cls[8];
+        for (int d = 0; d < 4; ++d)
+        {
+            int idx = Board::lineIndex(d, ny, nx);
+            int pos = Board::linePos(d, ny, nx);
+            uint32_t bit = 1u << pos;
+            uint32_t empty = board.emptyMask(idx) & ~bit;
+            cls[d] = Pattern::classify(board.lines[me][idx] | bit, empty, pos);
+            cls[4 + d] =
+                Pattern::classify(board.lines[opp][idx] | bit, empty, pos);
+        }
 
-                if (len >= 5)
-                {
-                    score += Config::Score::SCORE_WIN;
-                }
-                else if (len == 4)
-                {
-                    if (openHead && openTail)
-                        score += Config::Score::SCORE_OPEN4; // 止められない
-                    else if (openHead || openTail)
-                        score +=
-                            Config::Score::SCORE_CLOSED4; // 止めないとやばい
-                }
-                else if (len == 3)
-                {
-                    if (openHead && openTail)
-                        score += Config::Score::
-                            SCORE_OPEN3; // 次にOpen4になるので非常に危険
-                    else if (openHead || openTail)
-                        score += Config::Score::SCORE_CLOSED3;
-                }
-                else if (len == 2)
-                {
-                    if (openHead && openTail)
-                        score += Config::Score::SCORE_OPEN2;
-                }
-            }
+        long long prio = 0;
+        // 1. 履歴 / killer / countermove
+        prio += t.history[me][ny][nx];
+        if (out[i] == killers[0])
+            prio += KILLER_BONUS[0];
+        else if (out[i] == killers[1])
+            prio += KILLER_BONUS[1];
+        if (out[i] == counter)
+            prio += COUNTER_BONUS;
+        // 2. 中央寄せ
+        prio += (10 - abs(ny - 9) - abs(nx - 9)) * 10;
+
+        // 3. 局所評価（攻撃・防御）
+        // 自分の攻撃手としての価値
+        long long atk = WEIGHT[cls[0]] + WEIGHT[cls[1]] + WEIGHT[cls[2]] +
+                        WEIGHT[cls[3]];
+        // 相手の攻撃を防ぐ価値（防御）
+        long long def = WEIGHT[cls[4]] + WEIGHT[cls[5]] + WEIGHT[cls[6]] +
+                        WEIGHT[cls[7]];
+
+        // 防御の重みを攻撃より少し高くすることで、危機を見逃さない
+        prio += atk * 10;
+        prio += def * 12;
+
+        out[i].score = prio;
+        for (int d = 0; d < 4; ++d)
+            attacking |= cls[d] >= Pattern::OPEN3;
+        // 相手がそこに打つと 活四/五、四四、四三 ができる
+        // (1方向では四止まりでも、2方向合わせると次に勝たれる)
+        bool mustBlock = false;
+        int fours = 0, threes = 0;
+        for (int d = 4; d < 8; ++d)
+        {
+            mustBlock |= cls[d] >= Pattern::OPEN4;
+            fours += cls[d] >= Pattern::FOUR;
+            threes += cls[d] == Pattern::OPEN3;
         }
+        mustBlock |= fours >= 2 || (fours == 1 && threes >= 1);
+        threatened |= mustBlock;
+        // 四を作る手と、そこを止めないと次に勝たれる受けの手だけが forcing
+        if (atk >= 100000 || mustBlock)
+            std::swap(out[i], out[forcingCount++]);
     }
-    return score;
-}
-
-// 候補手生成 & 優先度付きソート
-std::vector<Move> AI::generateMoves(Board &board)
-{
-    std::vector<Move> moves;
-    // 探索範囲: 石がある場所の近傍2マス以内
-    bool visited[Config::BOARD_SIZE][Config::BOARD_SIZE] = {};
 
-    // 攻撃と防御の重要ポイントを簡易計算するためのヘルパー
-    auto evalPoint = [&](int y, int x, Player p) -> long long
+    // 脅威を受けているときは、相手の石を取って形を崩す手も受けに数える
+    if (threatened)
     {
-        long long s = 0;
-        int dy[] = {0, 1, 1, 1};
-        int dx[] = {1, 0, 1, -1};
-        for (int d = 0; d < 4; ++d)
+        CellSet caps = ThreatSolver::captureSquares(board, me);
+        for (int i = forcingCount; i < count && !caps.empty(); ++i)
         {
-            int len = 1;
-            // 正方向
-            int ty = y + dy[d], tx = x + dx[d];
-            while (board.get(ty, tx) == p)
-            {
-                len++;
-                ty += dy[d];
-                tx += dx[d];
-            }
-            // 負方向
-            ty = y - dy[d];
-            tx = x - dx[d];
-            while (board.get(ty, tx) == p)
-            {
-                len++;
-                ty -= dy[d];
-                tx -= dx[d];
-            }
-
-            // 簡易スコア: 長さの指数関数的重み
-            if (len >= 5)
-                s += 1000000;
-            else if (len == 4)
-                s += 100000;
-            else if (len == 3)
-                s += 10000;
-            else if (len == 2)
-                s += 100;
+            if (caps.has(out[i].y, out[i].x))
+                std::swap(out[i], out[forcingCount++]);
         }
-        return s;
-    };
+    }
 
-    Player me = board.currentTurn;
-    Player opp = (me == BLACK ? WHITE : BLACK);
+    return count;
+}
+
+bool AI::nextMove(SearchThread &t, MovePicker &mp, Move &out)
+{
+    Board &board = t.board;
+    bool black = (board.currentTurn == BLACK);
 
-    for (int y = 0; y < Config::BOARD_SIZE; ++y)
+    switch (mp.stage)
     {
-        for (int x = 0; x < Config::BOARD_SIZE; ++x)
+    case MovePicker::TT_MOVE:
+        mp.stage = MovePicker::GENERATE;
+        if (mp.ttMove.y >= 0 &&
+            board.grid[mp.ttMove.y][mp.ttMove.x] == NONE &&
+            !(black && board.isDoubleThree(mp.ttMove.y, mp.ttMove.x)))
         {
-            if (board.grid[y][x] != NONE)
+            out = mp.ttMove;
+            mp.picked++;
+            mp.lastForcing = false;
+            return true;
+        }
+        [[fallthrough]];
+
+    case MovePicker::GENERATE:
+        mp.count = generateMoves(t, mp.moves, mp.forcingCount, mp.threatened,
+                                 mp.attacking);
+        if (mp.threatened)
+            mp.beam = std::min(mp.beam, Config::BEAM_THREATENED);
+        mp.stage = MovePicker::PICK;
+        [[fallthrough]];
+
+    case MovePicker::PICK:
+        while (mp.index < mp.count)
+        {
+            // Beam Width制限 (TT手も1手に数える, 四の攻防の手は除く)
+            if (mp.index >= mp.forcingCount && mp.picked >= mp.beam)
+                break;
+            // 四の攻防の範囲 → 残りの範囲の順に、最大の手を1つずつ選ぶ
+            int end = (mp.index < mp.forcingCount) ? mp.forcingCount : mp.count;
+            int best = mp.index;
+            for (int i = mp.index + 1; i < end; ++i)
             {
-                for (int dy = -2; dy <= 2; ++dy)
-                {
-                    for (int dx = -2; dx <= 2; ++dx)
-                    {
-                        int ny = y + dy;
-                        int nx = x + dx;
-                        if (board.isValid(ny, nx) &&
-                            board.grid[ny][nx] == NONE && !visited[ny][nx])
-                        {
-                            visited[ny][nx] = true;
-
-                            if (me == BLACK && board.isDoubleThree(ny, nx))
-                                continue;
-
-                            long long prio = 0;
-                            // 1. 履歴
-                            prio += history[ny][nx];
-                            // 2. 中央寄せ
-                            prio += (10 - abs(ny - 9) - abs(nx - 9)) * 10;
-
-                            // 3. 局所評価（攻撃・防御）
-                            // 自分の攻撃手としての価値
-                            long long atk = evalPoint(ny, nx, me);
-                            // 相手の攻撃を防ぐ価値（防御）
-                            long long def = evalPoint(ny, nx, opp);
-
-                            // 防御の重みを攻撃より少し高くすることで、危機を見逃さない
-                            prio += atk * 10;
-                            prio += def * 12;
-
-                            moves.push_back({ny, nx, prio});
-                        }
-                    }
-                }
+                if (mp.moves[i].score > mp.moves[best].score)
+                    best = i;
             }
-        }
-    }
+            std::swap(mp.moves[mp.index], mp.moves[best]);
+            bool forcing = mp.index < mp.forcingCount;
+            const Move &m = mp.moves[mp.index++];
 
-    // スコア順にソート（重要）
-    std::sort(moves.begin(), moves.end(),
-              [](const Move &a, const Move &b) { return a.score > b.score; });
+            if (m == mp.ttMove || (black && board.isDoubleThree(m.y, m.x)))
+                continue;
+            out = m;
+            mp.picked++;
+            mp.lastForcing = forcing;
+            return true;
+        }
+        mp.stage = MovePicker::DONE;
+        return false;
 
-    // Beam Width制限（ただし重要な手が漏れないよう幅を広げる）
-    if (moves.size() > Config::BEAM_WIDTH)
-    {
-        moves.resize(Config::BEAM_WIDTH);
+    default:
+        return false;
     }
-
-    return moves;
 }
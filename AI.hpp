@@ -1,18 +1,40 @@
 #pragma once
 
 #include "Board.hpp"
+#include "OpeningBook.hpp"
+#include "SearchStats.hpp"
+#include "ThreatSolver.hpp"
+#include "TimeManager.hpp"
+#include "TranspositionTable.hpp"
+#include <atomic>
 #include <chrono>
 #include <climits>
+#include <condition_variable>
 #include <cstring>
-#include <unordered_map>
+#include <mutex>
 
-struct TTEntry
+// 直近の探索結果 (ベンチマークやログ用)
+// stats / selDepth は GOMOKU_STATS のビルドでだけ集計される
+struct SearchInfo
 {
-    uint64_t key;
-    int depth;
-    int score;
-    TTFlag flag;
+    struct Iteration
+    {
+        int depth;
+        int selDepth;
+        long long nodes; // その反復までの累計
+        double timeSec;  // 反復完了までの経過時間
+        double ebf;      // この反復と前の反復のノード数から求めた実効分岐数
+        SearchStats stats; // その反復までの累計 (メインスレッド)
+    };
+
+    const char *source; // "book" / "threat" / "search"
+    int depth;          // 完了した反復の最大深さ
+    int selDepth;
+    long long nodes;
+    double timeSec;
     Move bestMove;
+    SearchStats stats; // 全スレッドの合計
+    std::vector<Iteration> iterations;
 };
 
 // AI Engine
@@ -22,25 +44,180 @@ class AI
   public:
     AI();
     Move getBestMove(Board &board, int maxDepth = Config::MAX_DEPTH);
+    // 新しい対局の開始時に呼ぶ (TTを空にする)
+    void newGame();
+    // 探索スレッド数 (Lazy SMP, 1ならシングルスレッド)
+    void setThreads(int n);
+    // 1手あたりの思考時間 (秒, 0以下なら無制限)
+    void setTimeLimit(double sec);
+    // 持ち時間 (残り時間と1手ごとの加算, 秒): 局面の難しさに応じて配分する
+    void setClock(double remainingSec, double incrementSec = 0);
+    // 1スレッドあたりの探索ノード数の上限 (0なら無制限)
+    void setNodeLimit(long long nodes);
+    // Transposition Table のサイズ (MB)
+    void setHashSize(size_t mb);
+    // 盤面の8つの対称形で TT のエントリを共有する (キーは対称形の最小ハッシュ)
+    void setCanonicalHash(bool on) { canonicalTT = on; }
+    // Late Move Reductions を使うか (自己対局での比較用)
+    void setLateMoveReductions(bool on) { useLmr = on; }
+    // 定跡ファイルを読み込む (失敗したら定跡なし)
+    bool loadBook(const std::string &path);
+    // 探索結果を標準出力に表示するか
+    void setVerbose(bool v);
+    // 探索ごとの統計を JSON で1行ずつ追記する (全インスタンスで共有)
+    // GOMOKU_STATS のビルドでだけ有効で、環境変数 GOMOKU_STATS_LOG でも指定できる
+    static bool openStatsLog(const std::string &path);
+    const SearchInfo &lastSearchInfo() const { return info; }
+    // 別スレッドから探索を中断させる (getBestMove はすぐに戻る)
+    // 中断要求は clearStop まで残るので、探索開始前の要求も取りこぼさない
+    // timeOut も立てて、ルートの VCF/VCT もすぐに止める
+    void requestStop()
+    {
+        stopRequested = true;
+        timeOut = true;
+    }
+    void clearStop() { stopRequested = false; }
+    // 相手の手番中の先読み (ponder): true の間は時間制限を止める
+    // false にした時点 (ponder hit) から1手分の思考時間を計り始める
+    void setPondering(bool on);
+    // TTに残っている局面の最善手 (相手の予想手, なければ y = -1)
+    Move predictMove(Board &board);
 
   private:
-    Move minimaxRoot(Board &board, int depth);
+    static constexpr int MAX_PLY = 64;
+    static constexpr int MAX_MOVES = Board::CELL_COUNT;
+
+    // ルートの候補手と直前の反復の結果
+    struct RootMove
+    {
+        Move move;
+        int score;       // 窓の中で確定した値 (alpha を超えなければ -INT_MAX)
+        long long nodes; // 部分木のノード数
+    };
+
+    // スレッドごとの探索状態 (TTと停止フラグのみ共有)
+    // 探索をまたいで使い回し、手の順序付けの表を次の探索に引き継ぐ
+    struct SearchThread
+    {
+        int id;
+        Board board;
+        int rootPly; // 探索開始時の board.moveCount()
+        // 手の順序付け: history は探索のたびに減衰させ、killer は消す
+        long long history[3][Config::BOARD_SIZE][Config::BOARD_SIZE]; // [手番]
+        Move killers[MAX_PLY][2]; // ply ごとにカットを起こした静かな手
+        // 直前の手 [手番][y][x] に対してカットを起こした手
+        Move counterMoves[3][Config::BOARD_SIZE][Config::BOARD_SIZE];
+        long long nodesVisited;
+        SearchStats stats;
+        // ルートの候補手 (反復ごとに並べ替えて次の反復の順序にする)
+        std::vector<RootMove> rootMoves;
+        // ply ごとの候補手バッファ (ノードごとの確保をしない)
+        Move moveStack[MAX_PLY][MAX_MOVES];
+    };
+
+    // 段階的な指し手選択: TT手 → 勝ち/四の攻防 → 残りを1手ずつ選択
+    // 候補手の生成・評価は TT手を試した後まで遅らせ、全体のソートはしない
+    // 四の攻防の手はビーム幅に関係なくすべて返す
+    struct MovePicker
+    {
+        enum Stage
+        {
+            TT_MOVE,
+            GENERATE,
+            PICK,
+            DONE
+        };
+
+        Move *moves;
+        Move ttMove;
+        Stage stage;
+        int count;
+        int forcingCount; // moves[0, forcingCount) は四を作る手/必ず受ける手
+        int index;
+        int picked;
+        int beam;         // 返す手数の上限 (四の攻防の手は除く)
+        bool threatened;  // 相手に次の勝ちの形がある (生成後に決まる)
+        bool attacking;   // 手番側に四/活三を作れる手がある (生成後に決まる)
+        bool lastForcing; // 最後に返した手が四の攻防の手か
+
+        MovePicker(Move *buffer, const Move &tt, int beamWidth)
+            : moves(buffer), ttMove(tt), stage(TT_MOVE), count(0),
+              forcingCount(0), index(0), picked(0), beam(beamWidth),
+              threatened(false), attacking(false), lastForcing(false)
+        {
+        }
+    };
+
+    // 残り深さ depth のノードのビーム幅
+    static int beamWidth(int depth)
+    {
+        return std::min(Config::BEAM_WIDTH,
+                        Config::BEAM_MIN + Config::BEAM_STEP * (depth - 1));
+    }
 
-    int negamax(Board &board, int depth, int alpha, int beta);
+    Move iterativeDeepening(SearchThread &t, int maxDepth);
+
+    // ルートの候補手を生成する (前の探索の最善手 = TT手を先頭に)
+    void initRootMoves(SearchThread &t);
+    // ルートの探索 (窓の外に出たら m.score はその側の境界値)
+    // searched: 最後まで読めた手の数 (時間切れのときは途中までの結果)
+    Move minimaxRoot(SearchThread &t, int depth, int alpha, int beta,
+                     int &searched);
+
+    int negamax(SearchThread &t, int depth, int alpha, int beta);
+
+    // 着手済みの子局面の値 (PVS): 最初の手だけ (alpha, beta) で、
+    // 残りは null window で調べて alpha を超えたら探索し直す
+    int pvsChild(SearchThread &t, int depth, int alpha, int beta, bool first);
 
     // 盤面全体の評価
     int evaluate(Board &board);
 
-    // パターン評価（4連、3連など）
-    int evaluatePattern(Board &board, Player p);
+    // 手の順序付けの表を空にする / 次の探索に向けて減衰させる
+    static void clearOrdering(SearchThread &t);
+    static void ageOrdering(SearchThread &t);
+    // カットを起こした手を順序付けの表に記録する
+    static void recordCutoff(SearchThread &t, const Move &m, int depth,
+                             int ply, bool quiet);
+
+    // 候補手生成 & 優先度付け (ソートはしない, 戻り値は手数)
+    // threatened: 相手が次に 活四/五/四四/四三 を作れる
+    // attacking: 手番側に 四/活三 以上を作れる手がある (VCF を読む目安)
+    int generateMoves(SearchThread &t, Move *out, int &forcingCount,
+                      bool &threatened, bool &attacking);
+
+    // 次に探索する手 (ビーム幅に達するか候補が尽きたら false)
+    bool nextMove(SearchThread &t, MovePicker &mp, Move &out);
+
+    // TTのキー: canonicalTT なら対称形の最小ハッシュで、sym はその変換
+    // TTの手は sym で変換した向きで保存し、取り出すときに逆変換する
+    uint64_t ttKey(const Board &board, int &sym) const;
+    static Move transformMove(int sym, const Move &m);
 
-    // 候補手生成 & 優先度付きソート
-    std::vector<Move> generateMoves(Board &board);
+    // 探索中だけ動くタイマー: 時間切れで timeOut を立てる
+    // ponder hit で期限が決まったときは timerCv で起こす
+    void runTimer();
+    static long long nowNs();
+    // info を統計ログに書き出す (GOMOKU_STATS のときのみ)
+    void writeStatsLog(const Board &board) const;
 
-    std::unordered_map<uint64_t, TTEntry> tt;
-    long long history[Config::BOARD_SIZE][Config::BOARD_SIZE];
+    TranspositionTable tt;
+    OpeningBook book;
+    std::vector<SearchThread> threads; // Lazy SMP の各スレッドの状態
     std::chrono::steady_clock::time_point startTime;
 
-    int nodesVisited;
-    bool timeOut;
+    int threadCount;
+    long long nodeLimit;
+    bool verbose;
+    bool canonicalTT;
+    bool useLmr;
+    long long nodesVisited;
+    SearchInfo info;
+    std::atomic<bool> timeOut;
+    std::atomic<bool> stopRequested;
+    std::mutex clockMutex; // 以下の時間管理の状態
+    std::condition_variable timerCv;
+    TimeManager timeManager;
+    bool pondering;  // true の間は時計を止める
+    bool searchDone; // タイマーの終了
 };
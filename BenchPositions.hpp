@@ -0,0 +1,41 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+// ベンチマーク / perft 共通の局面 (自己対局から抜き出した着手列)
+struct BenchPosition
+{
+    const char *name;
+    std::vector<std::pair<int, int>> moves; // (y, x) の着手順
+};
+
+inline const std::vector<BenchPosition> BENCH_POSITIONS = {
+    {"opening-1", {{7, 11}, {11, 10}, {10, 10}, {10, 9}, {9, 8}, {12, 11}}},
+    {"opening-2",
+     {{7, 11}, {8, 10}, {11, 8}, {10, 9}, {7, 9}, {7, 8}, {7, 10}, {8, 8},
+      {9, 8}}},
+    {"middle-1",
+     {{10, 9}, {8, 11}, {10, 11}, {10, 12}, {10, 10}, {8, 12}, {8, 10},
+      {8, 13}, {8, 14}, {7, 12}, {6, 12}, {7, 11}, {10, 8}, {10, 7}, {7, 13},
+      {9, 12}, {11, 12}, {5, 11}}},
+    {"middle-2",
+     {{7, 8}, {10, 9}, {11, 9}, {8, 9}, {9, 8}, {8, 11}, {8, 8}, {10, 8},
+      {10, 10}, {10, 7}, {9, 10}, {10, 6}, {10, 5}, {8, 10}, {6, 8}, {5, 8},
+      {11, 10}, {11, 7}, {12, 10}, {13, 10}, {12, 8}, {9, 9}}},
+    {"capture-1",
+     {{8, 11}, {9, 7}, {8, 7}, {7, 12}, {9, 8}, {11, 9}, {12, 10}, {10, 9},
+      {10, 10}, {13, 10}, {12, 9}, {12, 11}, {11, 12}, {14, 9}, {7, 6},
+      {12, 8}, {13, 7}, {6, 5}, {8, 8}, {8, 9}, {11, 9}, {12, 8}, {11, 11},
+      {15, 8}}},
+    {"capture-2",
+     {{8, 10}, {9, 9}, {7, 7}, {7, 9}, {8, 6}, {9, 5}, {6, 8}, {5, 9}, {6, 9},
+      {6, 10}, {6, 7}, {8, 7}, {6, 6}, {6, 5}, {7, 6}, {9, 6}, {5, 6}, {4, 6},
+      {8, 8}, {5, 7}, {3, 5}, {4, 6}, {6, 7}, {7, 11}, {5, 11}, {6, 10}}},
+    {"capture-3",
+     {{8, 10}, {9, 9}, {7, 7}, {7, 9}, {8, 6}, {9, 5}, {6, 8}, {5, 9}, {6, 9},
+      {6, 10}, {6, 7}, {8, 7}, {6, 6}, {6, 5}, {7, 6}, {9, 6}, {5, 6}, {4, 6},
+      {8, 8}, {5, 7}, {3, 5}, {4, 6}, {6, 7}, {7, 11}, {5, 11}, {6, 10},
+      {4, 8}, {10, 5}, {11, 4}, {9, 7}, {9, 8}, {8, 5}, {7, 5}, {5, 8},
+      {7, 8}, {10, 8}, {11, 9}, {10, 8}}},
+};
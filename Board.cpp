@@ -1,123 +1,367 @@
 #include "Board.hpp"
+#include "Pattern.hpp"
+#include <algorithm>
 #include <cstring>
 
-Board::Board() { reset(); }
+Board::Board() : symmetryHashing(false) { reset(); }
 
 void Board::reset()
 {
     std::memset(grid, 0, sizeof(grid));
+    std::memset(lines, 0, sizeof(lines));
     captures[BLACK] = 0;
     captures[WHITE] = 0;
     hash = 0;
+    std::memset(symHash, 0, sizeof(symHash));
     currentTurn = BLACK;
     lastMove = {-1, -1};
+    winFlags = 0;
+    std::memset(lineScore, 0, sizeof(lineScore));
+    patternScore[BLACK] = 0;
+    patternScore[WHITE] = 0;
+    dirtyLines[0] = dirtyLines[1] = 0;
+    std::memset(nearCount, 0, sizeof(nearCount));
+    std::memset(nearMask, 0, sizeof(nearMask));
+    std::memset(stoneMask, 0, sizeof(stoneMask));
+    undoCount = 0;
+    savedCount = 0;
 }
 
-inline bool Board::isValid(int y, int x) const
+// 石の配置とラインビットボードの同期
+void Board::setStone(int y, int x, Player p)
 {
-    return y >= 0 && y < Config::BOARD_SIZE && x >= 0 && x < Config::BOARD_SIZE;
+    grid[y][x] = p;
+    for (int d = 0; d < 4; ++d)
+    {
+        int idx = lineIndex(d, y, x);
+        lines[p][idx] |= 1u << linePos(d, y, x);
+        dirtyLines[idx >> 6] |= 1ull << (idx & 63);
+    }
+    updateNear(y, x, 1);
+    if (symmetryHashing)
+        toggleSymHash(y, x, p);
+}
+
+void Board::clearStone(int y, int x)
+{
+    Player p = grid[y][x];
+    if (symmetryHashing)
+        toggleSymHash(y, x, p);
+    grid[y][x] = NONE;
+    for (int d = 0; d < 4; ++d)
+    {
+        int idx = lineIndex(d, y, x);
+        lines[p][idx] &= ~(1u << linePos(d, y, x));
+        dirtyLines[idx >> 6] |= 1ull << (idx & 63);
+    }
+    updateNear(y, x, -1);
+}
+
+// 対称形のハッシュは、変換先のマスの乱数を XOR する (置く/取るで同じ)
+void Board::toggleSymHash(int y, int x, Player p)
+{
+    int c = y * Config::BOARD_SIZE + x;
+    for (int s = 0; s < Symmetry::COUNT; ++s)
+    {
+        int t = Symmetry::CELLS[s][c];
+        symHash[s] ^= zobrist.table[t / Config::BOARD_SIZE]
+                                   [t % Config::BOARD_SIZE][p];
+    }
+}
+
+void Board::setSymmetryHashing(bool on)
+{
+    if (on && !symmetryHashing)
+        symmetryHashes(symHash);
+    symmetryHashing = on;
+}
+
+void Board::symmetryHashes(uint64_t out[Symmetry::COUNT]) const
+{
+    if (symmetryHashing)
+    {
+        std::memcpy(out, symHash, sizeof(symHash));
+        return;
+    }
+    uint64_t turn = (currentTurn == WHITE) ? zobrist.turnHash : 0;
+    for (int s = 0; s < Symmetry::COUNT; ++s)
+        out[s] = turn;
+    for (int c = 0; c < CELL_COUNT; ++c)
+    {
+        Player p = grid[c / Config::BOARD_SIZE][c % Config::BOARD_SIZE];
+        if (p == NONE)
+            continue;
+        for (int s = 0; s < Symmetry::COUNT; ++s)
+        {
+            int t = Symmetry::CELLS[s][c];
+            out[s] ^= zobrist.table[t / Config::BOARD_SIZE]
+                                   [t % Config::BOARD_SIZE][p];
+        }
+    }
 }
 
-inline Player Board::get(int y, int x) const
+uint64_t Board::canonicalHash(int &sym) const
 {
-    if (!isValid(y, x))
-        return OUT_OF_BOARD;
-    return grid[y][x];
+    uint64_t h[Symmetry::COUNT];
+    symmetryHashes(h);
+    sym = 0;
+    for (int s = 1; s < Symmetry::COUNT; ++s)
+    {
+        if (h[s] < h[sym])
+            sym = s;
+    }
+    return h[sym];
 }
 
-MoveResult Board::makeMove(int y, int x)
+// 周囲 NEAR_RANGE マスの参照カウントを増減し、0 との境界で集合を更新
+void Board::updateNear(int y, int x, int delta)
 {
-    if (grid[y][x] != NONE)
-        return {false, {}, 0};
+    int c = y * Config::BOARD_SIZE + x;
+    stoneMask[c >> 6] ^= 1ull << (c & 63);
 
-    MoveResult res;
-    res.prevHash = hash;
-    res.executed = true;
+    int y0 = std::max(0, y - NEAR_RANGE);
+    int y1 = std::min(Config::BOARD_SIZE - 1, y + NEAR_RANGE);
+    int x0 = std::max(0, x - NEAR_RANGE);
+    int x1 = std::min(Config::BOARD_SIZE - 1, x + NEAR_RANGE);
+    for (int ny = y0; ny <= y1; ++ny)
+    {
+        for (int nx = x0; nx <= x1; ++nx)
+        {
+            nearCount[ny][nx] += delta;
+            // 0 <-> 1 に変わったときだけビットを反転する
+            if (nearCount[ny][nx] == (delta > 0 ? 1 : 0))
+            {
+                int n = ny * Config::BOARD_SIZE + nx;
+                nearMask[n >> 6] ^= 1ull << (n & 63);
+            }
+        }
+    }
+}
+
+// 石の増減があったラインだけ両プレイヤー分を再評価して合計を補正
+// rec があれば書き換える前の評価を savedScores に積む
+void Board::rescoreDirtyLines(UndoRecord *rec)
+{
+    if (rec)
+    {
+        int n = __builtin_popcountll(dirtyLines[0]) +
+                __builtin_popcountll(dirtyLines[1]);
+        if (savedCount + n <= MAX_SAVED_LINES)
+            rec->savedLines = n;
+        else
+            rec = nullptr;
+    }
 
-    grid[y][x] = currentTurn;
+    for (int w = 0; w < 2; ++w)
+    {
+        while (dirtyLines[w])
+        {
+            int idx = w * 64 + __builtin_ctzll(dirtyLines[w]);
+            dirtyLines[w] &= dirtyLines[w] - 1;
+
+            if (rec)
+                savedScores[savedCount++] = {(uint8_t)idx,
+                                             {lineScore[BLACK][idx],
+                                              lineScore[WHITE][idx]}};
+            for (int p = BLACK; p <= WHITE; ++p)
+            {
+                int s = scoreLine((Player)p, idx);
+                patternScore[p] += s - lineScore[p][idx];
+                lineScore[p][idx] = s;
+            }
+        }
+    }
+}
+
+// makeMove で退避した評価を書き戻す (退避していなければ再計算)
+void Board::restoreLineScores(const UndoRecord &rec)
+{
+    if (rec.savedLines == 0)
+    {
+        rescoreDirtyLines(nullptr);
+        return;
+    }
+    dirtyLines[0] = dirtyLines[1] = 0;
+    for (int i = 0; i < rec.savedLines; ++i)
+    {
+        const SavedScore &sl = savedScores[--savedCount];
+        for (int p = BLACK; p <= WHITE; ++p)
+        {
+            patternScore[p] += sl.score[p - BLACK] - lineScore[p][sl.idx];
+            lineScore[p][sl.idx] = sl.score[p - BLACK];
+        }
+    }
+}
+
+int Board::scoreLine(Player p, int idx) const
+{
+    uint32_t m = lines[p][idx];
+    uint32_t empty = emptyMask(idx);
+
+    // 相手の石・盤外と、3つ以上続く空きで区切った石のまとまりを1つの形とし、
+    // まとまりごとに一番強い形を足し合わせる
+    // (間に空きが3つある石どうしは、同じ5マスに入っても二より強くならない)
+    uint32_t gap = empty & (empty >> 1) & (empty >> 2);
+    uint32_t sep = ~(m | empty) | gap | (gap << 1) | (gap << 2);
+
+    int score = 0;
+    while (m)
+    {
+        int start = __builtin_ctz(m);
+        int len = __builtin_ctz(sep >> start);
+        uint32_t seg = m & (((1u << len) - 1) << start);
+        m &= ~seg;
+
+        // ほかのまとまりの石は空きとみなして分類する
+        uint32_t e = empty | (lines[p][idx] & ~seg);
+        int best = Pattern::NONE;
+        for (uint32_t r = seg; r && best != Pattern::FIVE; r &= r - 1)
+            best = std::max<int>(best, Pattern::classify(seg, e,
+                                                         __builtin_ctz(r)));
+        score += Pattern::SCORE[best];
+    }
+    return score;
+}
+
+int Board::lineRun(Player p, int y, int x, int dir) const
+{
+    uint32_t m = lines[p][lineIndex(dir, y, x)];
+    int pos = linePos(dir, y, x);
+
+    // 正方向: pos+1 から続く1の数
+    int len = 1 + __builtin_ctz(~(m >> (pos + 1)));
+    // 負方向: pos-1 から下に続く1の数
+    uint32_t gaps = ~m & ((1u << pos) - 1);
+    len += gaps ? pos - 1 - (31 - __builtin_clz(gaps)) : pos;
+    return len;
+}
+
+bool Board::makeMove(int y, int x)
+{
+    if (grid[y][x] != NONE || undoCount == MAX_UNDO)
+        return false;
+
+    UndoRecord &rec = undoStack[undoCount++];
+    rec.prevHash = hash;
+    rec.y = y;
+    rec.x = x;
+    rec.prevLastY = lastMove.y;
+    rec.prevLastX = lastMove.x;
+    rec.captureDirs = 0;
+    rec.prevWinFlags = winFlags;
+    rec.savedLines = 0;
+
+    setStone(y, x, currentTurn);
     hash ^= zobrist.table[y][x][currentTurn];
 
     Player opp = (currentTurn == BLACK) ? WHITE : BLACK;
-    int dy[] = {-1, -1, -1, 0, 0, 1, 1, 1};
-    int dx[] = {-1, 0, 1, -1, 1, -1, 0, 1};
 
-    for (int i = 0; i < 8; ++i)
+    // X O O X: ライン上で pos±1, pos±2 が相手、pos±3 が自分なら捕獲
+    for (int d = 0; d < 4; ++d)
     {
-        int y1 = y + dy[i], x1 = x + dx[i];
-        int y2 = y + dy[i] * 2, x2 = x + dx[i] * 2;
-        int y3 = y + dy[i] * 3, x3 = x + dx[i] * 3;
+        int idx = lineIndex(d, y, x);
+        int pos = linePos(d, y, x);
 
-        if (get(y1, x1) == opp && get(y2, x2) == opp &&
-            get(y3, x3) == currentTurn)
+        for (int sign = 1; sign >= -1; sign -= 2)
         {
-            grid[y1][x1] = NONE;
-            grid[y2][x2] = NONE;
+            if (sign < 0 && pos < 3)
+                break;
+            int nearPos = (sign > 0) ? pos + 1 : pos - 2;
+            if (((lines[opp][idx] >> nearPos) & 3u) != 3u ||
+                !((lines[currentTurn][idx] >> (pos + sign * 3)) & 1u))
+                continue;
+
+            int y1 = y + DIR_DY[d] * sign, x1 = x + DIR_DX[d] * sign;
+            int y2 = y1 + DIR_DY[d] * sign, x2 = x1 + DIR_DX[d] * sign;
+
+            clearStone(y1, x1);
+            clearStone(y2, x2);
 
             hash ^= zobrist.table[y1][x1][opp];
             hash ^= zobrist.table[y2][x2][opp];
 
             captures[currentTurn] += 2;
-            res.capturedStones.push_back({y1, x1});
-            res.capturedStones.push_back({y2, x2});
+            rec.captureDirs |= 1 << (d * 2 + (sign < 0));
         }
     }
 
+    rescoreDirtyLines(&rec);
+
+    // 勝利判定の差分更新: 新しい5連は置いた石を通るラインにしか生じない
+    if (rec.captureDirs && (winFlags & (1 << opp)))
+    {
+        // 捕獲で相手の5連が崩れた可能性があるので相手側のみ再判定
+        winFlags &= ~(1 << opp);
+        if (captures[opp] >= 10 || hasFive(opp))
+            winFlags |= 1 << opp;
+    }
+    if (captures[currentTurn] >= 10)
+        winFlags |= 1 << currentTurn;
+    for (int d = 0; d < 4; ++d)
+    {
+        if (lineRun(currentTurn, y, x, d) >= 5)
+            winFlags |= 1 << currentTurn;
+    }
+
     hash ^= zobrist.turnHash;
+    if (symmetryHashing)
+    {
+        for (uint64_t &h : symHash)
+            h ^= zobrist.turnHash;
+    }
     currentTurn = opp;
     lastMove = {y, x};
-    return res;
+    return true;
 }
 
-void Board::undoMove(int y, int x, const MoveResult &res)
+void Board::undoMove()
 {
+    if (undoCount == 0)
+        return;
+
+    const UndoRecord &rec = undoStack[--undoCount];
     Player prevPlayer = (currentTurn == BLACK) ? WHITE : BLACK;
 
-    for (auto &p : res.capturedStones)
+    // 捕獲された2石 (相手 = 現在の手番の石) を方向ビットから復元
+    for (int bits = rec.captureDirs; bits; bits &= bits - 1)
     {
-        grid[p.first][p.second] = currentTurn;
-        captures[prevPlayer] -= 1;
+        int b = __builtin_ctz(bits);
+        int sign = (b & 1) ? -1 : 1;
+        int dy = DIR_DY[b >> 1] * sign, dx = DIR_DX[b >> 1] * sign;
+        setStone(rec.y + dy, rec.x + dx, currentTurn);
+        setStone(rec.y + dy * 2, rec.x + dx * 2, currentTurn);
+        captures[prevPlayer] -= 2;
     }
 
-    grid[y][x] = NONE;
+    clearStone(rec.y, rec.x);
+    restoreLineScores(rec);
 
-    hash = res.prevHash;
+    hash = rec.prevHash;
+    if (symmetryHashing)
+    {
+        for (uint64_t &h : symHash)
+            h ^= zobrist.turnHash;
+    }
+    winFlags = rec.prevWinFlags;
+    lastMove = Move(rec.prevLastY, rec.prevLastX);
     currentTurn = prevPlayer;
 }
 
+// makeMove/undoMove で維持しているキャッシュを返すだけ (O(1))
 bool Board::checkWin(Player p, bool checkCanBreak)
 {
-    if (captures[p] >= 10)
-        return true;
-
-    int dy[] = {0, 1, 1, 1};
-    int dx[] = {1, 0, 1, -1};
+    (void)checkCanBreak; // 捕獲による5連崩しは未対応
+    return winFlags & (1 << p);
+}
 
-    for (int y = 0; y < Config::BOARD_SIZE; ++y)
+bool Board::hasFive(Player p) const
+{
+    // 5連: 1ビットずつずらしたANDが残るライン
+    for (int i = 0; i < LINE_COUNT; ++i)
     {
-        for (int x = 0; x < Config::BOARD_SIZE; ++x)
-        {
-            if (grid[y][x] != p)
-                continue;
-
-            for (int i = 0; i < 4; ++i)
-            {
-                int count = 1;
-                int ty = y + dy[i], tx = x + dx[i];
-                while (get(ty, tx) == p)
-                {
-                    count++;
-                    ty += dy[i];
-                    tx += dx[i];
-                }
-
-                if (count >= 5)
-                {
-                    if (!checkCanBreak)
-                        return true;
-                    return true;
-                }
-            }
-        }
+        uint32_t m = lines[p][i];
+        if (m & (m >> 1) & (m >> 2) & (m >> 3) & (m >> 4))
+            return true;
     }
     return false;
 }
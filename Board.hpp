@@ -1,28 +1,189 @@
 #pragma once
 
 #include "Config.hpp"
+#include "Symmetry.hpp"
 #include "Types.hpp"
 #include "Zobrist.hpp"
+#include <array>
 #include <vector>
 
+namespace BoardLines
+{
+constexpr int N = Config::BOARD_SIZE;
+// ライン数: 横19 + 縦19 + 斜め37 + 逆斜め37
+constexpr int COUNT = N * 2 + (N * 2 - 1) * 2;
+
+// 各ラインで盤内に存在する位置のマスク
+constexpr std::array<uint32_t, COUNT> buildValid()
+{
+    std::array<uint32_t, COUNT> v{};
+    for (int y = 0; y < N; ++y)
+    {
+        for (int x = 0; x < N; ++x)
+        {
+            v[y] |= 1u << x;
+            v[N + x] |= 1u << y;
+            v[N * 2 + (x - y + N - 1)] |= 1u << y;
+            v[N * 4 - 1 + (x + y)] |= 1u << y;
+        }
+    }
+    return v;
+}
+inline constexpr std::array<uint32_t, COUNT> VALID = buildValid();
+} // namespace BoardLines
+
 class Board
 {
   public:
+    static constexpr int LINE_COUNT = BoardLines::COUNT;
+    static constexpr int CELL_COUNT = Config::BOARD_SIZE * Config::BOARD_SIZE;
+    static constexpr int CELL_WORDS = (CELL_COUNT + 63) / 64;
+    // 候補手の範囲: 石から NEAR_RANGE マス以内
+    static constexpr int NEAR_RANGE = 2;
+    // 着手履歴の上限 (盤面の全マス + 捕獲で空いたマスへの再着手分)
+    static constexpr int MAX_UNDO = 512;
+
     Player grid[Config::BOARD_SIZE][Config::BOARD_SIZE];
+    // プレイヤー別のラインビットボード (bit = ライン上の位置)
+    uint32_t lines[3][LINE_COUNT];
     int captures[3];
     uint64_t hash;
+    // 8つの対称形それぞれの Zobrist ハッシュ (symHash[0] == hash)
+    // symmetryHashing が on の間だけ makeMove/undoMove で差分更新する
+    uint64_t symHash[Symmetry::COUNT];
+    bool symmetryHashing;
     Player currentTurn;
     Move lastMove;
+    // 勝利判定キャッシュ (bit p: 5連 or 10個捕獲済み)
+    uint8_t winFlags;
+    // パターン評価キャッシュ: ライン毎のスコアとその合計
+    int lineScore[3][LINE_COUNT];
+    int patternScore[3];
+    // 候補手集合: 近傍の石の数 (参照カウント) と、それが1以上のマスのビット集合
+    uint8_t nearCount[Config::BOARD_SIZE][Config::BOARD_SIZE];
+    uint64_t nearMask[CELL_WORDS];
+    uint64_t stoneMask[CELL_WORDS];
 
     Board();
     void reset();
-    MoveResult makeMove(int y, int x);
-    void undoMove(int y, int x, const MoveResult &res);
+    // 置けなかった場合 (石がある / 履歴が一杯) は false
+    bool makeMove(int y, int x);
+    // 直前の makeMove を取り消す (lastMove も戻る)
+    void undoMove();
+    int moveCount() const { return undoCount; }
+    // 対称形のハッシュの差分更新を切り替える (on にした時点で盤面から計算)
+    // 対称形で TT を共有する探索と定跡の作成でだけ使う
+    void setSymmetryHashing(bool on);
+    // 8つの対称形のハッシュ (差分更新していなければ盤面から計算する)
+    void symmetryHashes(uint64_t out[Symmetry::COUNT]) const;
+    // 対称形のハッシュの最小値と、それを与える変換
+    uint64_t canonicalHash(int &sym) const;
     bool checkWin(Player p, bool checkCanBreak = true);
     bool isDoubleThree(int y, int x);
-    bool isValid(int y, int x) const;
-    Player get(int y, int x) const;
+    bool isValid(int y, int x) const
+    {
+        return y >= 0 && y < Config::BOARD_SIZE && x >= 0 &&
+               x < Config::BOARD_SIZE;
+    }
+    Player get(int y, int x) const
+    {
+        if (!isValid(y, x))
+            return OUT_OF_BOARD;
+        return grid[y][x];
+    }
+
+    // 方向 dir (0:横 1:縦 2:斜め 3:逆斜め) のライン番号と位置
+    // 位置は DIR_DY/DIR_DX 方向に1進むごとに+1
+    static int lineIndex(int dir, int y, int x)
+    {
+        switch (dir)
+        {
+        case 0:
+            return y;
+        case 1:
+            return Config::BOARD_SIZE + x;
+        case 2:
+            return Config::BOARD_SIZE * 2 + (x - y + Config::BOARD_SIZE - 1);
+        default:
+            return Config::BOARD_SIZE * 4 - 1 + (x + y);
+        }
+    }
+    static int linePos(int dir, int y, int x) { return dir == 0 ? x : y; }
+    // lineIndex/linePos の逆変換
+    static void lineCell(int idx, int pos, int &y, int &x)
+    {
+        constexpr int N = Config::BOARD_SIZE;
+        if (idx < N)
+        {
+            y = idx;
+            x = pos;
+            return;
+        }
+        y = pos;
+        if (idx < N * 2)
+            x = idx - N;
+        else if (idx < N * 4 - 1)
+            x = pos + (idx - N * 2) - (N - 1);
+        else
+            x = (idx - (N * 4 - 1)) - pos;
+    }
+
+    // ライン上の空きマス（盤外のビットは立たない）
+    uint32_t emptyMask(int idx) const
+    {
+        return BoardLines::VALID[idx] &
+               ~(lines[BLACK][idx] | lines[WHITE][idx]);
+    }
+
+    // (y, x) に p を置いたと仮定した方向 dir の連の長さ
+    int lineRun(Player p, int y, int x, int dir) const;
+
+    // ライン1本分のパターン評価 (石のまとまりごとの一番強い形の合計)
+    int scoreLine(Player p, int idx) const;
+
+    // 石から NEAR_RANGE マス以内の空点を y, x の昇順に列挙する
+    template <typename F> void forEachCandidate(F &&f) const
+    {
+        for (int w = 0; w < CELL_WORDS; ++w)
+        {
+            uint64_t m = nearMask[w] & ~stoneMask[w];
+            while (m)
+            {
+                int c = w * 64 + __builtin_ctzll(m);
+                m &= m - 1;
+                f(c / Config::BOARD_SIZE, c % Config::BOARD_SIZE);
+            }
+        }
+    }
+
+    static constexpr int DIR_DY[4] = {0, 1, 1, 1};
+    static constexpr int DIR_DX[4] = {1, 0, 1, -1};
 
   private:
     bool checkFreeThree(int y, int x, int dy, int dx);
+    bool hasFive(Player p) const;
+    void setStone(int y, int x, Player p);
+    void clearStone(int y, int x);
+    void toggleSymHash(int y, int x, Player p);
+    void rescoreDirtyLines(UndoRecord *rec);
+    void restoreLineScores(const UndoRecord &rec);
+    void updateNear(int y, int x, int delta);
+
+    // setStone/clearStone で変化したライン (LINE_COUNT <= 128)
+    uint64_t dirtyLines[2];
+
+    UndoRecord undoStack[MAX_UNDO];
+    int undoCount;
+
+    // makeMove で書き換える前のライン評価 (undoMove で再計算せずに戻す)
+    // 1手で変わるのは置いた石の4本 + 捕獲した石ごとに3本 (最大52本)
+    // 捕獲のない手は4本なので1手平均8本分を確保し、溢れた手は undo 時に再計算
+    struct SavedScore
+    {
+        uint8_t idx;
+        int score[2]; // [黒, 白]
+    };
+    static constexpr int MAX_SAVED_LINES = MAX_UNDO * 8;
+    SavedScore savedScores[MAX_SAVED_LINES];
+    int savedCount;
 };
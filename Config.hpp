@@ -1,5 +1,4 @@
 #pragma once
-#include <SFML/Graphics.hpp>
 
 namespace Config
 {
@@ -15,7 +14,34 @@ constexpr unsigned int WINDOW_H = 850;
 // AI Performance
 constexpr double TIME_LIMIT_SEC = 0.48;
 constexpr int MAX_DEPTH = 10;
-constexpr int BEAM_WIDTH = 30;
+constexpr int BEAM_WIDTH = 30;      // ビーム幅の上限 (残り深さで変わる)
+constexpr int BEAM_WIDTH_ROOT = 40; // ルートのビーム幅
+constexpr int BEAM_MIN = 8;         // 残り深さ1のビーム幅
+constexpr int BEAM_STEP = 4;        // 残り深さが1増えるごとに広げる幅
+constexpr int BEAM_THREATENED = 8;  // 相手に活三/四があるときのビーム幅
+constexpr int HISTORY_AGING = 4;    // 探索のたびに history をこの値で割る
+// Late Move Reductions: 静かな後半の手を浅く読む
+constexpr int LMR_MIN_DEPTH = 3;  // この深さ以上で減らす
+constexpr int LMR_MIN_MOVES = 3;  // この手数より後の手を1手減らす
+constexpr int LMR_LATE_MOVES = 10; // この手数より後の手は2手減らす
+constexpr int TT_SIZE_MB = 64;    // Transposition Table のサイズ
+constexpr int SEARCH_THREADS = 1; // Lazy SMP の探索スレッド数
+constexpr bool TT_CANONICAL = false; // 対称形で TT のエントリを共有するか
+constexpr int ASPIRATION_WINDOW = 20000; // ルートの窓の半幅 (外れるたび4倍)
+
+// 時間管理 (TimeManager)
+constexpr double TIME_OPTIMUM_RATIO = 0.6; // 1手の時間のうち次の反復に進む目安
+constexpr int TIME_MOVES_TO_GO = 25;       // 持ち時間制での残り手数の見積もり
+constexpr double TIME_MARGIN_SEC = 0.03;   // 通信などの余裕
+
+constexpr const char *BOOK_FILE = "gomoku.book"; // 定跡 (なければ使わない)
+
+// 脅威空間探索 (VCF/VCT) の読みの上限: 手数 (両者の手を含む) と局面数
+constexpr int VCF_MAX_PLIES = 15;
+constexpr int VCT_MAX_PLIES = 7;
+constexpr long long VCF_ROOT_NODES = 20000;
+constexpr long long VCT_ROOT_NODES = 5000;
+constexpr long long VCF_SEARCH_NODES = 100; // 探索中のノードで使う分
 
 // AI Scores
 namespace Score
@@ -29,9 +55,4 @@ constexpr int SCORE_OPEN2 = 3000;
 constexpr int SCORE_CAPTURE = 150000; // 捕獲価値
 constexpr double DEF_BIAS = 1.2;      // 防御の重み
 } // namespace Score
-
-// UI Colors
-const sf::Color COLOR_BG(222, 184, 135);
-const sf::Color COLOR_LINE(0, 0, 0, 200);
-const sf::Color COLOR_TEXT(20, 20, 20);
 } // namespace Config
@@ -0,0 +1,283 @@
+#include "EngineProtocol.hpp"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <thread>
+
+EngineProtocol::EngineProtocol(std::istream &in, std::ostream &out)
+    : in(in), out(out), started(false), inputClosed(false), searching(false)
+{
+    ai.setVerbose(false);
+    ai.loadBook(Config::BOOK_FILE);
+    // 入力は別スレッドで読むので、読むたびに出力を flush させない
+    // (std::cin は std::cout に結び付いていて、応答の書き込みと競合する)
+    in.tie(nullptr);
+}
+
+void EngineProtocol::run()
+{
+    std::thread reader(&EngineProtocol::readLoop, this);
+    std::string line;
+    while (nextLine(line))
+    {
+        if (!handleLine(line))
+            break;
+    }
+    // 入力スレッドは END か入力の終わりを読んだところで止まっている
+    reader.join();
+}
+
+void EngineProtocol::readLoop()
+{
+    std::string line;
+    bool end = false;
+    while (!end && std::getline(in, line))
+    {
+        end = command(line) == "END";
+        std::lock_guard<std::mutex> lock(queueMutex);
+        lines.push_back(line);
+        queueCv.notify_all();
+    }
+    std::lock_guard<std::mutex> lock(queueMutex);
+    inputClosed = true;
+    queueCv.notify_all();
+}
+
+bool EngineProtocol::nextLine(std::string &line)
+{
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueCv.wait(lock, [this] { return !lines.empty() || inputClosed; });
+    if (lines.empty())
+        return false;
+    line = lines.front();
+    lines.pop_front();
+    return true;
+}
+
+std::string EngineProtocol::command(const std::string &line)
+{
+    std::string cmd;
+    std::istringstream(line) >> cmd;
+    std::transform(cmd.begin(), cmd.end(), cmd.begin(),
+                   [](unsigned char c) { return std::toupper(c); });
+    return cmd;
+}
+
+bool EngineProtocol::handleLine(const std::string &line)
+{
+    std::string cmd = command(line);
+    if (cmd.empty())
+        return true;
+
+    std::istringstream ss(line);
+    std::string word, args;
+    ss >> word;
+    std::getline(ss >> std::ws, args);
+
+    if (cmd == "END")
+        return false;
+    if (cmd == "STOP")
+        return true; // 思考中でなければ止めるものはない
+    if (cmd == "START")
+        cmdStart(args);
+    else if (cmd == "ABOUT")
+        out << "name=\"gomoku\", version=\"1.0\"" << std::endl;
+    else if (cmd == "INFO")
+        cmdInfo(args);
+    else if (!started)
+        out << "ERROR board not started" << std::endl;
+    else if (cmd == "RESTART")
+    {
+        newGame();
+        out << "OK" << std::endl;
+    }
+    else if (cmd == "BEGIN")
+        think();
+    else if (cmd == "TURN")
+        cmdTurn(args);
+    else if (cmd == "BOARD")
+        cmdBoard();
+    else if (cmd == "TAKEBACK")
+        cmdTakeback(args);
+    else
+        out << "UNKNOWN " << cmd << std::endl;
+    return true;
+}
+
+void EngineProtocol::cmdStart(const std::string &args)
+{
+    int size = 0;
+    std::istringstream(args) >> size;
+    if (size != Config::BOARD_SIZE)
+    {
+        out << "ERROR unsupported size " << size << " (only "
+            << Config::BOARD_SIZE << ")" << std::endl;
+        return;
+    }
+    started = true;
+    newGame();
+    out << "OK" << std::endl;
+}
+
+void EngineProtocol::cmdTurn(const std::string &args)
+{
+    int y, x;
+    std::string error;
+    if (!parseMove(args, y, x))
+        out << "ERROR bad move " << args << std::endl;
+    else if (!playMove(y, x, error))
+        out << "ERROR " << error << std::endl;
+    else
+        think();
+}
+
+void EngineProtocol::cmdBoard()
+{
+    // 捕獲があるので着手順に並んでいる前提で先頭から再生する
+    newGame();
+    std::string line, error;
+    bool ok = true;
+    while (nextLine(line))
+    {
+        std::string upper = line;
+        std::transform(upper.begin(), upper.end(), upper.begin(),
+                       [](unsigned char c) { return std::toupper(c); });
+        if (upper.find("DONE") != std::string::npos)
+            break;
+        if (!ok)
+            continue;
+
+        int y, x;
+        if (!parseMove(line, y, x))
+        {
+            ok = false;
+            error = "bad move " + line;
+        }
+        else if (!playMove(y, x, error))
+            ok = false;
+    }
+
+    if (!ok)
+        out << "ERROR " << error << std::endl;
+    else
+        think();
+}
+
+void EngineProtocol::cmdTakeback(const std::string &args)
+{
+    int y, x;
+    if (!parseMove(args, y, x) || board.moveCount() == 0 ||
+        !(board.lastMove == Move(y, x)))
+    {
+        out << "ERROR cannot take back " << args << std::endl;
+        return;
+    }
+    board.undoMove();
+    out << "OK" << std::endl;
+}
+
+void EngineProtocol::cmdInfo(const std::string &args)
+{
+    std::istringstream ss(args);
+    std::string key;
+    long long value = 0;
+    if (!(ss >> key >> value))
+        return;
+
+    if (key == "timeout_turn")
+        ai.setTimeLimit(std::max(1LL, value) / 1000.0);
+    else if (key == "timeout_match")
+        ai.setClock(value / 1000.0); // 0 なら持ち時間なし
+    else if (key == "time_left")
+        ai.setClock(std::max(1LL, value) / 1000.0);
+    else if (key == "max_memory" && value > 0)
+        ai.setHashSize(value / 2 / (1024 * 1024)); // 残りは盤面やスタック用
+    else if (key == "thread_num")
+        ai.setThreads((int)value);
+}
+
+bool EngineProtocol::parseMove(const std::string &s, int &y, int &x) const
+{
+    char comma;
+    std::istringstream ss(s);
+    if (!(ss >> x >> comma >> y) || comma != ',')
+        return false;
+    return board.isValid(y, x);
+}
+
+bool EngineProtocol::playMove(int y, int x, std::string &error)
+{
+    if (board.get(y, x) != NONE)
+    {
+        error = "occupied " + std::to_string(x) + "," + std::to_string(y);
+        return false;
+    }
+    if (board.isDoubleThree(y, x))
+    {
+        error = "forbidden " + std::to_string(x) + "," + std::to_string(y);
+        return false;
+    }
+    if (!board.makeMove(y, x))
+    {
+        error = "move history is full";
+        return false;
+    }
+    return true;
+}
+
+void EngineProtocol::newGame()
+{
+    board.reset();
+    ai.newGame();
+}
+
+void EngineProtocol::think()
+{
+    Player prev = (board.currentTurn == BLACK) ? WHITE : BLACK;
+    if (board.checkWin(prev))
+    {
+        out << "ERROR game is over" << std::endl;
+        return;
+    }
+
+    // 探索は別スレッドで行い、その間に届いた STOP / END で打ち切る
+    // 打ち切られた探索もそこまでの最善手を返す
+    ai.clearStop();
+    Move m;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        searching = true;
+    }
+    std::thread search(
+        [this, &m]
+        {
+            m = ai.getBestMove(board);
+            std::lock_guard<std::mutex> lock(queueMutex);
+            searching = false;
+            queueCv.notify_all();
+        });
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        while (searching)
+        {
+            for (auto it = lines.begin(); it != lines.end();)
+            {
+                std::string cmd = command(*it);
+                if (cmd == "STOP" || cmd == "END")
+                    ai.requestStop();
+                // END は思考の後で処理して終了する
+                it = (cmd == "STOP") ? lines.erase(it) : it + 1;
+            }
+            queueCv.wait(lock);
+        }
+    }
+    search.join();
+
+    std::string error;
+    if (m.y < 0 || !playMove(m.y, m.x, error))
+    {
+        out << "ERROR no legal move" << std::endl;
+        return;
+    }
+    out << m.x << "," << m.y << std::endl;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "AI.hpp"
+#include "Board.hpp"
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+// GUIなしで AI を動かすための行単位テキストプロトコル (Gomocup/piskvork 準拠)
+//   START 19 / RESTART / BEGIN / TURN x,y / BOARD ... DONE
+//   TAKEBACK x,y / INFO key value / ABOUT / STOP / END
+// 座標は piskvork と同じく "x,y" (x: 列, y: 行)
+// 入力は専用のスレッドで読み、思考中に届いた STOP で探索を打ち切る
+// (STOP 以外のコマンドは思考が終わってから順に処理する)
+class EngineProtocol
+{
+  public:
+    EngineProtocol(std::istream &in, std::ostream &out);
+    void run();
+
+  private:
+    // 入力スレッド: 1行ずつキューに積む (END か入力の終わりで止まる)
+    void readLoop();
+    // 次の1行 (入力が終わっていれば false)
+    bool nextLine(std::string &line);
+    static std::string command(const std::string &line);
+
+    // END を受け取ったら false
+    bool handleLine(const std::string &line);
+    void cmdStart(const std::string &args);
+    void cmdTurn(const std::string &args);
+    void cmdBoard();
+    void cmdTakeback(const std::string &args);
+    void cmdInfo(const std::string &args);
+
+    bool parseMove(const std::string &s, int &y, int &x) const;
+    bool playMove(int y, int x, std::string &error);
+    void newGame();
+    void think();
+
+    std::istream &in;
+    std::ostream &out;
+    Board board;
+    AI ai;
+    bool started;
+
+    // 入力スレッドとのやり取り (queueMutex で保護)
+    std::mutex queueMutex;
+    std::condition_variable queueCv;
+    std::deque<std::string> lines;
+    bool inputClosed;
+    bool searching;
+};
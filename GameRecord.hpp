@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Config.hpp"
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 棋譜の1行表現: SGF と同じ2文字座標 (列, 行 の順に 'a' から) を並べる
+//   例: "jj kj ik"  /  ";B[jj];W[kj];B[ik]" もそのまま読める
+// 座標として読めない (小文字2文字で a〜s 以外の) トークンは無視する
+// 行に結果 (自己対局の棋譜など) があれば parseResult で読める
+namespace GameRecord
+{
+// (y, x) の着手列にする
+inline std::vector<std::pair<int, int>> parse(const std::string &line)
+{
+    std::vector<std::pair<int, int>> moves;
+    size_t i = 0;
+    while (i < line.size())
+    {
+        if (line[i] < 'a' || line[i] > 'z')
+        {
+            ++i;
+            continue;
+        }
+        size_t j = i;
+        while (j < line.size() && line[j] >= 'a' && line[j] <= 'z')
+            ++j;
+        if (j - i == 2)
+        {
+            int x = line[i] - 'a', y = line[i + 1] - 'a';
+            if (x < Config::BOARD_SIZE && y < Config::BOARD_SIZE)
+                moves.push_back({y, x});
+        }
+        i = j;
+    }
+    return moves;
+}
+
+// 結果 (黒-白: "1-0" / "0-1" / "1/2-1/2") を黒から見た得点にする
+// (勝ち 2, 引き分け 1, 負け 0)。結果が書かれていなければ false
+inline bool parseResult(const std::string &line, int &blackScore)
+{
+    std::istringstream ss(line);
+    std::string token;
+    bool found = false;
+    while (ss >> token)
+    {
+        if (token == "1-0" || token == "0-1" || token == "1/2-1/2")
+        {
+            blackScore = (token == "1-0") ? 2 : (token == "0-1") ? 0 : 1;
+            found = true;
+        }
+    }
+    return found;
+}
+
+inline std::string format(const std::vector<std::pair<int, int>> &moves)
+{
+    std::string line;
+    for (const auto &m : moves)
+    {
+        if (!line.empty())
+            line += ' ';
+        line += (char)('a' + m.second);
+        line += (char)('a' + m.first);
+    }
+    return line;
+}
+} // namespace GameRecord
@@ -7,13 +7,17 @@ GomokuGame::GomokuGame()
              "42 Gomoku AI - High Defense"),
       statusText(), guideText(), timerText(), mode(GameMode::HumanVsAI),
       userColor(BLACK), gameOver(false), winner(NONE), replayIndex(-1),
-      isReplayMode(false)
+      isReplayMode(false), aiThinking(false), aiMoveIndex(0),
+      isPondering(false)
 {
     window.setFramerateLimit(60);
     loadFont();
     initText();
+    ai.loadBook(Config::BOOK_FILE);
 }
 
+GomokuGame::~GomokuGame() { cancelSearch(); }
+
 void GomokuGame::run()
 {
     while (window.isOpen())
@@ -66,13 +70,17 @@ void GomokuGame::processEvents()
     {
         if (event.type == sf::Event::Closed)
         {
+            cancelSearch();
             window.close();
         }
 
         if (event.type == sf::Event::KeyPressed)
         {
             if (event.key.code == sf::Keyboard::Escape)
+            {
+                cancelSearch();
                 window.close();
+            }
             if (event.key.code == sf::Keyboard::R)
                 resetGame();
 
@@ -154,6 +162,8 @@ void GomokuGame::doMove(int y, int x)
 
     if (board.checkWin(justMoved, true))
     {
+        // 人間の手で終局したら先読みも止める (ponder 中は時間制限がない)
+        cancelSearch();
         gameOver = true;
         winner = justMoved;
         statusText.setString(std::string(winner == BLACK ? "Black" : "White") +
@@ -168,29 +178,107 @@ void GomokuGame::doMove(int y, int x)
 void GomokuGame::update()
 {
     if (gameOver)
+    {
+        cancelSearch(); // 終局後に探索を残さない (何もなければすぐ戻る)
+        return;
+    }
+    if (mode != GameMode::HumanVsAI || board.currentTurn == userColor)
         return;
 
-    if (mode == GameMode::HumanVsAI && board.currentTurn != userColor)
+    if (!aiThinking)
     {
-        statusText.setString("AI Thinking...");
-        window.draw(statusText);
-        window.display();
+        if (!ponderHit())
+            startSearch();
+        return;
+    }
 
-        sf::Clock clock;
-        Move bestMove = ai.getBestMove(board);
-        float time = clock.getElapsedTime().asSeconds();
-        timerText.setString(std::to_string(time).substr(0, 4) + "s");
+    float time = aiClock.getElapsedTime().asSeconds();
+    timerText.setString(std::to_string(time).substr(0, 4) + "s");
+    if (aiResult.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return;
 
-        if (bestMove.y != -1)
-        {
-            doMove(bestMove.y, bestMove.x);
-        }
-        else
-        {
-            gameOver = true;
-            statusText.setString("AI Resigns. You Win!");
-        }
+    Move bestMove = aiResult.get();
+    aiThinking = false;
+    // 探索中に盤面が変わっていたら結果は使わない (次のフレームで探索し直す)
+    if (aiMoveIndex != moveHistory.size())
+        return;
+
+    if (bestMove.y != -1)
+    {
+        doMove(bestMove.y, bestMove.x);
+        if (!gameOver)
+            startPonder();
     }
+    else
+    {
+        gameOver = true;
+        statusText.setString("AI Resigns. You Win!");
+    }
+}
+
+void GomokuGame::startSearch()
+{
+    statusText.setString("AI Thinking...");
+    aiClock.restart();
+    aiMoveIndex = moveHistory.size();
+    aiThinking = true;
+
+    ai.clearStop();
+    Board snapshot = board;
+    aiResult = std::async(std::launch::async, [this, snapshot]() mutable
+                          { return ai.getBestMove(snapshot); });
+}
+
+void GomokuGame::startPonder()
+{
+    Board snapshot = board;
+    ponderMove = ai.predictMove(snapshot);
+    if (ponderMove.y != -1)
+        snapshot.makeMove(ponderMove.y, ponderMove.x);
+    isPondering = true;
+
+    // 予想手がなければ人間の手番の局面をそのまま読み、TTだけを育てる
+    ai.clearStop();
+    ai.setPondering(true);
+    aiResult = std::async(std::launch::async, [this, snapshot]() mutable
+                          { return ai.getBestMove(snapshot); });
+}
+
+bool GomokuGame::ponderHit()
+{
+    if (!isPondering)
+        return false;
+    isPondering = false;
+
+    const auto &last = moveHistory.back();
+    if (ponderMove.y != -1 && last.first == ponderMove.y &&
+        last.second == ponderMove.x)
+    {
+        // 先読み中の探索を、ここから1手分の時間制限で続ける
+        ai.setPondering(false);
+        statusText.setString("AI Thinking... (ponder hit)");
+        aiClock.restart();
+        aiMoveIndex = moveHistory.size();
+        aiThinking = true;
+        return true;
+    }
+
+    // 外れ: 探索は止めるが TT の内容はそのまま次の探索に使う
+    ai.requestStop();
+    aiResult.get();
+    ai.setPondering(false);
+    return false;
+}
+
+void GomokuGame::cancelSearch()
+{
+    if (!aiThinking && !isPondering)
+        return;
+    ai.requestStop();
+    aiResult.get();
+    ai.setPondering(false);
+    aiThinking = false;
+    isPondering = false;
 }
 
 void GomokuGame::render()
@@ -277,7 +365,9 @@ void GomokuGame::updateStatusText()
 
 void GomokuGame::resetGame()
 {
+    cancelSearch();
     board.reset();
+    ai.newGame();
     moveHistory.clear();
     gameOver = false;
     winner = NONE;
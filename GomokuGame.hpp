@@ -2,9 +2,10 @@
 
 #include "AI.hpp"
 #include "Board.hpp"
-#include "Config.hpp"
 #include "Types.hpp"
+#include "UIConfig.hpp"
 #include <SFML/Graphics.hpp>
+#include <future>
 #include <string>
 #include <vector>
 
@@ -29,8 +30,18 @@ class GomokuGame
     int replayIndex;
     bool isReplayMode;
 
+    // AIの探索は別スレッドで盤面のコピーに対して行い、描画は止めない
+    std::future<Move> aiResult;
+    bool aiThinking;
+    size_t aiMoveIndex; // 探索を始めたときの moveHistory.size()
+    sf::Clock aiClock;
+    // 人間の手番中は予想手を打った局面を先読みする (aiResult を共用)
+    bool isPondering;
+    Move ponderMove; // 予想手 (予想できなければ現局面を先読み)
+
   public:
     GomokuGame();
+    ~GomokuGame();
     void run();
 
   private:
@@ -44,6 +55,12 @@ class GomokuGame
     void drawStone(int y, int x, sf::Color c);
     void updateStatusText();
     void resetGame();
+    void startSearch();
+    void startPonder();
+    // 人間が指した後: 予想が当たれば先読みをそのまま続ける
+    bool ponderHit();
+    // 探索中なら中断して結果を捨てる (スレッドの終了まで待つ)
+    void cancelSearch();
 
     // リプレイ関連
     void startReplay();
@@ -0,0 +1,180 @@
+#include "OpeningBook.hpp"
+#include "Symmetry.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+OpeningBook::OpeningBook()
+    : mapping(nullptr), mappingSize(0), entries(nullptr), count(0)
+{
+}
+
+OpeningBook::~OpeningBook() { close(); }
+
+bool OpeningBook::open(const std::string &path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(BookHeader))
+    {
+        ::close(fd);
+        return false;
+    }
+    // ページは参照したときに読まれるので、大きな定跡でも起動は一瞬
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+        return false;
+
+    const BookHeader *header = static_cast<const BookHeader *>(p);
+    size_t expected =
+        sizeof(BookHeader) + (size_t)header->count * sizeof(BookEntry);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header->version != VERSION || expected > (size_t)st.st_size)
+    {
+        munmap(p, st.st_size);
+        return false;
+    }
+
+    mapping = p;
+    mappingSize = st.st_size;
+    entries = reinterpret_cast<const BookEntry *>(header + 1);
+    count = header->count;
+    return true;
+}
+
+void OpeningBook::close()
+{
+    if (mapping)
+        munmap(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+    entries = nullptr;
+    count = 0;
+}
+
+uint64_t OpeningBook::canonicalKey(const Board &board, int &sym)
+{
+    return board.canonicalHash(sym);
+}
+
+uint16_t OpeningBook::canonicalMove(const Board &board, int y, int x)
+{
+    int sym;
+    uint64_t key = board.canonicalHash(sym);
+    uint64_t symHash[Symmetry::COUNT];
+    board.symmetryHashes(symHash);
+
+    int best = Board::CELL_COUNT;
+    for (int s = 0; s < Symmetry::COUNT; ++s)
+    {
+        if (symHash[s] != key)
+            continue;
+        best = std::min<int>(best,
+                             Symmetry::CELLS[s][y * Config::BOARD_SIZE + x]);
+    }
+    return (uint16_t)best;
+}
+
+Move OpeningBook::probe(Board &board, std::mt19937 *rng) const
+{
+    if (!entries)
+        return Move();
+
+    int sym;
+    uint64_t key = canonicalKey(board, sym);
+    const BookEntry *first = std::lower_bound(
+        entries, entries + count, key,
+        [](const BookEntry &e, uint64_t k) { return e.key < k; });
+
+    // 候補: 同じキーのエントリのうち、元の盤面で打てる手
+    std::vector<std::pair<Move, uint32_t>> moves;
+    uint32_t total = 0;
+    for (const BookEntry *e = first; e != entries + count && e->key == key;
+         ++e)
+    {
+        int y, x;
+        Symmetry::transform(Symmetry::INVERSE[sym],
+                            e->move / Config::BOARD_SIZE,
+                            e->move % Config::BOARD_SIZE, y, x);
+        if (board.grid[y][x] != NONE ||
+            (board.currentTurn == BLACK && board.isDoubleThree(y, x)))
+            continue;
+        moves.push_back({Move(y, x, e->weight), e->weight});
+        total += e->weight;
+    }
+    if (moves.empty() || total == 0)
+        return Move();
+
+    if (rng)
+    {
+        std::uniform_int_distribution<uint32_t> dist(0, total - 1);
+        uint32_t r = dist(*rng);
+        for (const auto &m : moves)
+        {
+            if (r < m.second)
+                return m.first;
+            r -= m.second;
+        }
+    }
+    return std::max_element(moves.begin(), moves.end(),
+                            [](const auto &a, const auto &b)
+                            { return a.second < b.second; })
+        ->first;
+}
+
+bool OpeningBook::write(const std::string &path,
+                        std::vector<BookEntry> entries, uint32_t minGames,
+                        double minScore)
+{
+    std::sort(entries.begin(), entries.end(),
+              [](const BookEntry &a, const BookEntry &b)
+              { return a.key != b.key ? a.key < b.key : a.move < b.move; });
+
+    // 同じ (キー, 手) は重みと局数を足して1つにする (重みは 65535 で飽和)
+    std::vector<BookEntry> merged;
+    for (const BookEntry &e : entries)
+    {
+        if (!merged.empty() && merged.back().key == e.key &&
+            merged.back().move == e.move)
+        {
+            uint32_t w = (uint32_t)merged.back().weight + e.weight;
+            merged.back().weight = (uint16_t)std::min<uint32_t>(w, 65535);
+            merged.back().games += e.games;
+        }
+        else
+            merged.push_back(e);
+    }
+
+    // 局数の少ない手・得点率の低い手を落とす
+    merged.erase(std::remove_if(merged.begin(), merged.end(),
+                                [&](const BookEntry &e)
+                                {
+                                    return e.weight == 0 ||
+                                           e.games < minGames ||
+                                           e.weight < minScore * 2 * e.games;
+                                }),
+                 merged.end());
+
+    BookHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.count = (uint32_t)merged.size();
+
+    FILE *f = std::fopen(path.c_str(), "wb");
+    if (!f)
+        return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1 &&
+              (merged.empty() ||
+               std::fwrite(merged.data(), sizeof(BookEntry), merged.size(),
+                           f) == merged.size());
+    return std::fclose(f) == 0 && ok;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Board.hpp"
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+// 定跡ファイル (バイナリ)
+//   ヘッダ: magic "GMKBOOK1", エントリ数
+//   エントリ: {局面キー, 手, 重み, 局数} をキーの昇順に並べたもの
+//   (同じキーは連続)。重みはその手を打った側から見た得点の合計
+//   (勝ち 2, 引き分け 1, 負け 0) で、probe は重みに比例して選ぶ
+// 局面キーは8つの対称変換のうち最小の Zobrist ハッシュ (Board::canonicalHash)、
+// 手はそのキーを与える向き (正規化した盤面) での座標で持つ
+struct BookHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+};
+
+struct BookEntry
+{
+    uint64_t key;
+    uint16_t move; // y * BOARD_SIZE + x (正規化した盤面での位置)
+    uint16_t weight;
+    uint32_t games; // この手が打たれた対局数
+};
+
+class OpeningBook
+{
+  public:
+    static constexpr char MAGIC[8] = {'G', 'M', 'K', 'B', 'O', 'O', 'K', '1'};
+    static constexpr uint32_t VERSION = 1;
+
+    OpeningBook();
+    ~OpeningBook();
+    OpeningBook(const OpeningBook &) = delete;
+    OpeningBook &operator=(const OpeningBook &) = delete;
+
+    // mmap で開く (ファイルがない/壊れていれば false で、空の定跡のまま)
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const { return entries != nullptr; }
+    size_t size() const { return count; }
+
+    // 定跡手を探す (なければ y = -1)
+    // rng を渡すと重みに比例して選び、なければ重みが最大の手を返す
+    Move probe(Board &board, std::mt19937 *rng = nullptr) const;
+
+    // 局面の正規化キーと、そのキーを与える対称変換
+    static uint64_t canonicalKey(const Board &board, int &sym);
+    // 手 (y, x) を正規化した盤面での位置に直す
+    // 局面自体が対称なら、同じ意味の手は1つの位置にまとまる
+    static uint16_t canonicalMove(const Board &board, int y, int x);
+
+    // エントリをソートし、同じ (キー, 手) の重みと局数をまとめて書き出す
+    // 局数が minGames 未満の手と、1局あたりの得点率 (重み / 2局数) が
+    // minScore 未満の手は入れない (負けた対局にしか出てこない手も入らない)
+    static bool write(const std::string &path, std::vector<BookEntry> entries,
+                      uint32_t minGames = 1, double minScore = 0);
+
+  private:
+    void *mapping;
+    size_t mappingSize;
+    const BookEntry *entries;
+    size_t count;
+};
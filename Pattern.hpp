@@ -0,0 +1,136 @@
+#pragma once
+
+#include "Config.hpp"
+#include <array>
+#include <cstdint>
+
+// ライン上の形の分類表 (コンパイル時に生成)
+// 石を中心とした9マスの窓を 自分/空き/ふさがり (相手 or 盤外) の3進数で表し、
+// 中心の石を含む一番強い形を引く。XX_XX や X_XXX などの飛び石も同じ扱い
+namespace Pattern
+{
+enum Class : uint8_t
+{
+    NONE,
+    OPEN2,   // 1手で活三
+    CLOSED3, // 1手で四
+    OPEN3,   // 1手で活四
+    FOUR,    // 5連になるマスが1つ
+    OPEN4,   // 5連になるマスが2つ以上
+    FIVE,
+    CLASS_COUNT
+};
+
+constexpr int WINDOW = 9;
+constexpr int CENTER = WINDOW / 2;
+constexpr uint32_t WINDOW_MASK = (1u << WINDOW) - 1;
+constexpr int INDEX_COUNT = 19683; // 3^9
+
+// 9ビットのマスク → 各ビットを3進数の桁に置き換えた値
+constexpr std::array<uint16_t, 1 << WINDOW> buildTernary()
+{
+    std::array<uint16_t, 1 << WINDOW> t{};
+    for (int m = 0; m < (1 << WINDOW); ++m)
+    {
+        int pow3 = 1;
+        for (int i = 0; i < WINDOW; ++i, pow3 *= 3)
+        {
+            if (m & (1 << i))
+                t[m] += pow3;
+        }
+    }
+    return t;
+}
+inline constexpr std::array<uint16_t, 1 << WINDOW> TERNARY = buildTernary();
+
+// 桁: 0 = 空き, 1 = 自分, 2 = ふさがり
+constexpr int index(uint32_t own, uint32_t blocked)
+{
+    return TERNARY[own] + 2 * TERNARY[blocked];
+}
+
+constexpr std::array<uint8_t, INDEX_COUNT> buildClasses()
+{
+    std::array<uint8_t, INDEX_COUNT> cls{};
+    // 石を1つ足すと添字が増えるので、大きい添字から埋めれば
+    // 1手後の形は必ず計算済み
+    for (int idx = INDEX_COUNT - 1; idx >= 0; --idx)
+    {
+        uint32_t own = 0, blocked = 0;
+        for (int i = 0, v = idx; i < WINDOW; ++i, v /= 3)
+        {
+            if (v % 3 == 1)
+                own |= 1u << i;
+            else if (v % 3 == 2)
+                blocked |= 1u << i;
+        }
+        if (!(own & (1u << CENTER)))
+            continue;
+
+        // 中心を含む5マスの枠で、5連と5連になるマスを調べる
+        uint32_t fives = 0;
+        bool five = false;
+        for (int s = 0; s <= CENTER; ++s)
+        {
+            uint32_t win = 0x1Fu << s;
+            if ((own & win) == win)
+                five = true;
+            else if (__builtin_popcount(own & win) == 4 && !(blocked & win))
+                fives |= win & ~own;
+        }
+        if (five)
+        {
+            cls[idx] = FIVE;
+            continue;
+        }
+        int n = __builtin_popcount(fives);
+        if (n >= 2)
+        {
+            cls[idx] = OPEN4;
+            continue;
+        }
+        if (n == 1)
+        {
+            cls[idx] = FOUR;
+            continue;
+        }
+
+        // 空きに1手足した形の最大から1段下げる
+        int best = NONE;
+        int pow3 = 1;
+        for (int i = 0; i < WINDOW; ++i, pow3 *= 3)
+        {
+            if (!((own | blocked) & (1u << i)) && cls[idx + pow3] > best)
+                best = cls[idx + pow3];
+        }
+        if (best == OPEN4)
+            cls[idx] = OPEN3;
+        else if (best == FOUR)
+            cls[idx] = CLOSED3;
+        else if (best == OPEN3)
+            cls[idx] = OPEN2;
+    }
+    return cls;
+}
+inline constexpr std::array<uint8_t, INDEX_COUNT> CLASSES = buildClasses();
+
+// 形ごとの評価値 (Config::Score から生成)
+inline constexpr std::array<int, CLASS_COUNT> SCORE = {
+    0,
+    Config::Score::SCORE_OPEN2,
+    Config::Score::SCORE_CLOSED3,
+    Config::Score::SCORE_OPEN3,
+    Config::Score::SCORE_CLOSED4,
+    Config::Score::SCORE_OPEN4,
+    Config::Score::SCORE_WIN,
+};
+
+// ライン上の位置 pos にある自分の石 (own に含む) を中心とした形
+// 窓が盤外にはみ出した部分はふさがり扱い
+inline Class classify(uint32_t own, uint32_t empty, int pos)
+{
+    uint32_t o = (uint32_t)(((uint64_t)own << CENTER) >> pos) & WINDOW_MASK;
+    uint32_t e = (uint32_t)(((uint64_t)empty << CENTER) >> pos) & WINDOW_MASK;
+    return (Class)CLASSES[index(o, ~(o | e) & WINDOW_MASK)];
+}
+} // namespace Pattern
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+
+// 探索の統計 (-DGOMOKU_STATS でビルドしたときだけ集計する)
+// 無効なときは記録用のメソッドが空になり、探索のコストは変わらない
+#ifdef GOMOKU_STATS
+constexpr bool STATS_ENABLED = true;
+#else
+constexpr bool STATS_ENABLED = false;
+#endif
+
+struct SearchStats
+{
+    // ベータカットを起こした手の順番 (0 が最初の手, 最後の要素はそれ以降)
+    static constexpr int CUTOFF_SLOTS = 16;
+
+    long long ttProbes = 0;
+    long long ttHits = 0;
+    long long ttCutoffs = 0; // TTの値だけで返したノード
+    long long betaCutoffs = 0;
+    long long cutoffIndex[CUTOFF_SLOTS] = {};
+    long long pvsResearches = 0;        // null window で alpha を超えた
+    long long aspirationResearches = 0; // ルートの窓から外れた
+    long long lmrReductions = 0;        // 浅く読んだ手
+    long long lmrResearches = 0;        // 浅い読みで alpha を超えた
+    int selDepth = 0;                   // ルートからの最大手数
+
+    void ttProbe(bool hit)
+    {
+        if constexpr (STATS_ENABLED)
+        {
+            ttProbes++;
+            ttHits += hit;
+        }
+    }
+    void ttCutoff()
+    {
+        if constexpr (STATS_ENABLED)
+            ttCutoffs++;
+    }
+    void betaCutoff(int index)
+    {
+        if constexpr (STATS_ENABLED)
+        {
+            betaCutoffs++;
+            cutoffIndex[std::min(index, CUTOFF_SLOTS - 1)]++;
+        }
+    }
+    void pvsResearch()
+    {
+        if constexpr (STATS_ENABLED)
+            pvsResearches++;
+    }
+    void aspirationResearch()
+    {
+        if constexpr (STATS_ENABLED)
+            aspirationResearches++;
+    }
+    void lmr(bool research)
+    {
+        if constexpr (STATS_ENABLED)
+        {
+            lmrReductions++;
+            lmrResearches += research;
+        }
+    }
+    void reach(int ply)
+    {
+        if constexpr (STATS_ENABLED)
+            selDepth = std::max(selDepth, ply);
+    }
+
+    void add(const SearchStats &o)
+    {
+        ttProbes += o.ttProbes;
+        ttHits += o.ttHits;
+        ttCutoffs += o.ttCutoffs;
+        betaCutoffs += o.betaCutoffs;
+        for (int i = 0; i < CUTOFF_SLOTS; ++i)
+            cutoffIndex[i] += o.cutoffIndex[i];
+        pvsResearches += o.pvsResearches;
+        aspirationResearches += o.aspirationResearches;
+        lmrReductions += o.lmrReductions;
+        lmrResearches += o.lmrResearches;
+        selDepth = std::max(selDepth, o.selDepth);
+    }
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Config.hpp"
+#include <array>
+#include <cstdint>
+
+// 盤面の8つの対称変換 (回転4 x 鏡映2)
+namespace Symmetry
+{
+constexpr int COUNT = 8;
+// 各変換の逆変換 (90度回転と270度回転が互いに逆, 他は自分自身)
+constexpr int INVERSE[COUNT] = {0, 3, 2, 1, 4, 5, 6, 7};
+
+// (y, x) を変換 s で移した位置
+constexpr void transform(int s, int y, int x, int &ty, int &tx)
+{
+    constexpr int L = Config::BOARD_SIZE - 1;
+    switch (s)
+    {
+    case 0: // そのまま
+        ty = y, tx = x;
+        break;
+    case 1: // 90度回転
+        ty = x, tx = L - y;
+        break;
+    case 2: // 180度回転
+        ty = L - y, tx = L - x;
+        break;
+    case 3: // 270度回転
+        ty = L - x, tx = y;
+        break;
+    case 4: // 左右反転
+        ty = y, tx = L - x;
+        break;
+    case 5: // 主対角線で反転
+        ty = x, tx = y;
+        break;
+    case 6: // 上下反転
+        ty = L - y, tx = x;
+        break;
+    default: // 副対角線で反転
+        ty = L - x, tx = L - y;
+        break;
+    }
+}
+
+constexpr int CELL_COUNT = Config::BOARD_SIZE * Config::BOARD_SIZE;
+
+// マス番号 (y * BOARD_SIZE + x) の変換表
+constexpr std::array<std::array<uint16_t, CELL_COUNT>, COUNT> buildCells()
+{
+    std::array<std::array<uint16_t, CELL_COUNT>, COUNT> t{};
+    for (int s = 0; s < COUNT; ++s)
+    {
+        for (int c = 0; c < CELL_COUNT; ++c)
+        {
+            int ty = 0, tx = 0;
+            transform(s, c / Config::BOARD_SIZE, c % Config::BOARD_SIZE, ty,
+                      tx);
+            t[s][c] = (uint16_t)(ty * Config::BOARD_SIZE + tx);
+        }
+    }
+    return t;
+}
+inline constexpr std::array<std::array<uint16_t, CELL_COUNT>, COUNT> CELLS =
+    buildCells();
+} // namespace Symmetry
@@ -0,0 +1,269 @@
+#include "ThreatSolver.hpp"
+#include <algorithm>
+
+namespace
+{
+// ライン上の5マスの枠のうち、own が stones 個で残りが空点の枠の空点
+uint32_t lineWindows(uint32_t own, uint32_t empty, int stones)
+{
+    uint32_t result = 0;
+    for (int s = 0; s + 5 <= Config::BOARD_SIZE; ++s)
+    {
+        uint32_t win = 0x1Fu << s;
+        if (__builtin_popcount(own & win) == stones &&
+            __builtin_popcount(empty & win) == 5 - stones)
+            result |= empty & win;
+    }
+    return result;
+}
+} // namespace
+
+ThreatSolver::ThreatSolver(Board &board, const std::atomic<bool> *stop)
+    : board(board), stop(stop), threes(false), budget(0), nodeCount(0), plies(-1),
+      rootMove(-1, -1), rootPly(0)
+{
+}
+
+bool ThreatSolver::solve(bool useThrees, int maxPlies, long long nodeBudget,
+                         Move &firstMove)
+{
+    threes = useThrees;
+    budget = nodeBudget;
+    nodeCount = 0;
+    rootMove = Move(-1, -1);
+    rootPly = board.moveCount();
+
+    plies = attack(maxPlies);
+    if (plies < 0)
+        return false;
+    firstMove = rootMove;
+    firstMove.score = Config::Score::SCORE_WIN;
+    return true;
+}
+
+bool ThreatSolver::exhausted()
+{
+    // 以降の局面は予算切れと同じ扱いにして打ち切る
+    if (stop && (nodeCount & 1023) == 0 &&
+        stop->load(std::memory_order_relaxed))
+        budget = 0;
+    return nodeCount > budget;
+}
+
+CellSet ThreatSolver::windowSquares(const Board &board, Player p, int stones)
+{
+    CellSet cells;
+    for (int i = 0; i < Board::LINE_COUNT; ++i)
+    {
+        uint32_t own = board.lines[p][i];
+        if (__builtin_popcount(own) < stones)
+            continue;
+        uint32_t m = lineWindows(own, board.emptyMask(i), stones);
+        while (m)
+        {
+            int y, x;
+            Board::lineCell(i, __builtin_ctz(m), y, x);
+            m &= m - 1;
+            cells.add(y, x);
+        }
+    }
+    return cells;
+}
+
+CellSet ThreatSolver::fiveSquares(const Board &board, Player p)
+{
+    return windowSquares(board, p, 4);
+}
+
+CellSet ThreatSolver::fourSquares(const Board &board, Player p)
+{
+    return windowSquares(board, p, 3);
+}
+
+CellSet ThreatSolver::captureSquares(const Board &board, Player p)
+{
+    Player opp = (p == BLACK) ? WHITE : BLACK;
+    CellSet cells;
+    for (int i = 0; i < Board::LINE_COUNT; ++i)
+    {
+        uint32_t own = board.lines[p][i];
+        uint32_t o = board.lines[opp][i];
+        if (!own || __builtin_popcount(o) < 2)
+            continue;
+        // 空 O O X を両方向に: pos+1, pos+2 が相手で pos+3 が自分
+        uint32_t empty = board.emptyMask(i);
+        uint32_t m = empty & (((o >> 1) & (o >> 2) & (own >> 3)) |
+                              ((o << 1) & (o << 2) & (own << 3)));
+        while (m)
+        {
+            int y, x;
+            Board::lineCell(i, __builtin_ctz(m), y, x);
+            m &= m - 1;
+            cells.add(y, x);
+        }
+    }
+    return cells;
+}
+
+bool ThreatSolver::isLegal(int y, int x)
+{
+    return board.grid[y][x] == NONE &&
+           !(board.currentTurn == BLACK && board.isDoubleThree(y, x));
+}
+
+bool ThreatSolver::findWin(Player p, Move &out)
+{
+    bool found = false;
+    auto check = [&](int y, int x)
+    {
+        if (!found && isLegal(y, x))
+        {
+            out = Move(y, x);
+            found = true;
+        }
+    };
+    fiveSquares(board, p).forEach(check);
+    // 8個取っていれば、もう1回の捕獲で勝ち
+    if (!found && board.captures[p] >= 8)
+        captureSquares(board, p).forEach(check);
+    return found;
+}
+
+bool ThreatSolver::openFours(Player p, CellSet &defence)
+{
+    bool found = false;
+    fourSquares(board, p).forEach(
+        [&](int y, int x)
+        {
+            // (y, x) に置いたときの5連のマスをライン毎に数える
+            CellSet fives;
+            for (int d = 0; d < 4; ++d)
+            {
+                int idx = Board::lineIndex(d, y, x);
+                uint32_t b = 1u << Board::linePos(d, y, x);
+                uint32_t m = lineWindows(board.lines[p][idx] | b,
+                                         board.emptyMask(idx) & ~b, 4);
+                while (m)
+                {
+                    int fy, fx;
+                    Board::lineCell(idx, __builtin_ctz(m), fy, fx);
+                    m &= m - 1;
+                    fives.add(fy, fx);
+                }
+            }
+            // 活四 or 四四: 1手では両方を止められない
+            if (fives.size() >= 2)
+            {
+                found = true;
+                defence |= fives;
+                defence.add(y, x);
+            }
+        });
+    return found;
+}
+
+int ThreatSolver::attack(int pliesLeft)
+{
+    nodeCount++;
+    if (exhausted())
+        return -1;
+
+    Player me = board.currentTurn;
+    Player opp = (me == BLACK) ? WHITE : BLACK;
+    bool atRoot = board.moveCount() == rootPly;
+
+    Move win;
+    if (findWin(me, win))
+    {
+        if (atRoot)
+            rootMove = win;
+        return 1;
+    }
+    // 攻め手 → 受け → 勝ち の3手が読めないなら打ち切り
+    if (pliesLeft < 3)
+        return -1;
+
+    CellSet fours = fourSquares(board, me);
+    CellSet others;
+    if (threes)
+        others = windowSquares(board, me, 2);
+
+    // 相手の四が残っているなら、それを止める手でしか攻められない
+    CellSet oppFives = fiveSquares(board, opp);
+    if (!oppFives.empty())
+    {
+        if (oppFives.size() > 1)
+            return -1;
+        fours &= oppFives;
+        others &= oppFives;
+    }
+
+    int result = -1;
+    auto tryMove = [&](int y, int x, bool fourOnly)
+    {
+        if (result >= 0 || nodeCount > budget || !isLegal(y, x))
+            return;
+        board.makeMove(y, x);
+
+        CellSet blocks = fiveSquares(board, me);
+        bool isFour = !blocks.empty();
+        if (isFour || (!fourOnly && openFours(me, blocks)))
+        {
+            int r = defend(pliesLeft - 1, isFour, blocks);
+            if (r >= 0)
+            {
+                result = r + 1;
+                if (atRoot)
+                    rootMove = Move(y, x);
+            }
+        }
+        board.undoMove();
+    };
+
+    // 四を先に、三 (VCT のみ) を後に試す
+    fours.forEach([&](int y, int x) { tryMove(y, x, true); });
+    others.forEach(
+        [&](int y, int x)
+        {
+            if (!fours.has(y, x))
+                tryMove(y, x, false);
+        });
+    return result;
+}
+
+int ThreatSolver::defend(int pliesLeft, bool isFour, const CellSet &blocks)
+{
+    nodeCount++;
+    if (exhausted())
+        return -1;
+
+    Player me = board.currentTurn;
+    Move win;
+    if (findWin(me, win))
+        return -1;
+
+    // 受け: 四なら5連のマス、三なら活四に関わるマス
+    // どちらも捕獲で崩す手があり、三に対しては逆四も受けになる
+    CellSet replies = blocks;
+    replies |= captureSquares(board, me);
+    if (!isFour)
+        replies |= fourSquares(board, me);
+
+    // 受けなかった場合: 四なら次の5連、三なら活四から5連まで
+    int worst = isFour ? 1 : 3;
+    bool refuted = false;
+    replies.forEach(
+        [&](int y, int x)
+        {
+            if (refuted || !isLegal(y, x))
+                return;
+            board.makeMove(y, x);
+            int r = attack(pliesLeft - 1);
+            board.undoMove();
+            if (r < 0)
+                refuted = true;
+            else
+                worst = std::max(worst, r);
+        });
+    return refuted ? -1 : worst + 1;
+}
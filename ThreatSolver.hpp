@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Board.hpp"
+#include <atomic>
+
+// 盤上のマスの集合 (bit = y * BOARD_SIZE + x)
+struct CellSet
+{
+    uint64_t w[Board::CELL_WORDS] = {};
+
+    void add(int y, int x)
+    {
+        int c = y * Config::BOARD_SIZE + x;
+        w[c >> 6] |= 1ull << (c & 63);
+    }
+    bool has(int y, int x) const
+    {
+        int c = y * Config::BOARD_SIZE + x;
+        return (w[c >> 6] >> (c & 63)) & 1ull;
+    }
+    bool empty() const
+    {
+        for (uint64_t v : w)
+        {
+            if (v)
+                return false;
+        }
+        return true;
+    }
+    int size() const
+    {
+        int n = 0;
+        for (uint64_t v : w)
+            n += __builtin_popcountll(v);
+        return n;
+    }
+    CellSet &operator|=(const CellSet &o)
+    {
+        for (int i = 0; i < Board::CELL_WORDS; ++i)
+            w[i] |= o.w[i];
+        return *this;
+    }
+    CellSet &operator&=(const CellSet &o)
+    {
+        for (int i = 0; i < Board::CELL_WORDS; ++i)
+            w[i] &= o.w[i];
+        return *this;
+    }
+    // y, x の昇順に列挙する
+    template <typename F> void forEach(F &&f) const
+    {
+        for (int i = 0; i < Board::CELL_WORDS; ++i)
+        {
+            uint64_t m = w[i];
+            while (m)
+            {
+                int c = i * 64 + __builtin_ctzll(m);
+                m &= m - 1;
+                f(c / Config::BOARD_SIZE, c % Config::BOARD_SIZE);
+            }
+        }
+    }
+};
+
+// 脅威空間探索 (VCF / VCT)
+// 攻め方は四 (VCT では三も) だけを指し、受け方は四を止める手・
+// 三の防ぎ手・逆四・捕獲による崩しだけを調べて、攻め方の必勝を読み切る
+class ThreatSolver
+{
+  public:
+    // stop が立ったら solve は読み切れなかったとして戻る
+    explicit ThreatSolver(Board &board,
+                          const std::atomic<bool> *stop = nullptr);
+
+    // 手番側の必勝手順を探す (見つかれば true, 初手を firstMove に入れる)
+    // useThrees = false なら四の連続 (VCF) のみ
+    // maxPlies: 読む手数 (両者の手を含む), nodeBudget: 局面数の上限
+    bool solve(bool useThrees, int maxPlies, long long nodeBudget,
+               Move &firstMove);
+    // 直前の solve で見つけた勝ちまでの手数 (勝ちの手を含む)
+    int winPlies() const { return plies; }
+    long long nodes() const { return nodeCount; }
+
+    // p が置くと5連になるマス
+    static CellSet fiveSquares(const Board &board, Player p);
+    // p が置くと四 (5連になるマスが生じる) になるマス
+    static CellSet fourSquares(const Board &board, Player p);
+    // p が置くと捕獲が起きるマス
+    static CellSet captureSquares(const Board &board, Player p);
+
+  private:
+    // 局面数の上限に達したか中断されたら true (中断は一定局面ごとに見る)
+    bool exhausted();
+    // 攻め方の手番: 勝ちまでの手数 (読み切れなければ -1)
+    int attack(int pliesLeft);
+    // 受け方の手番: blocks は止めるべきマス (直前の攻め手が四なら isFour)
+    int defend(int pliesLeft, bool isFour, const CellSet &blocks);
+    // p が次の1手で勝てるマス (5連 or 10個目の捕獲)
+    bool findWin(Player p, Move &out);
+    // 盤面の手番 p が (y, x) に置けるか
+    bool isLegal(int y, int x);
+    // p が次に活四/四四 (5連のマスが2つ以上) を作れるか
+    // 作れるなら、その手と5連のマスを defence に加える
+    bool openFours(Player p, CellSet &defence);
+    // 5連の枠 (5マス) の中に p の石が stones 個、残りが空点のマス
+    static CellSet windowSquares(const Board &board, Player p, int stones);
+
+    Board &board;
+    const std::atomic<bool> *stop;
+    bool threes;
+    long long budget;
+    long long nodeCount;
+    int plies;
+    Move rootMove;
+    int rootPly;
+};
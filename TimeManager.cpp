@@ -0,0 +1,104 @@
+#include "TimeManager.hpp"
+#include "Config.hpp"
+#include <algorithm>
+#include <climits>
+
+namespace
+{
+// 評価値がこれだけ下がったら optimum を2倍まで伸ばす (活三1つ分)
+constexpr double SCORE_SWING = Config::Score::SCORE_OPEN3;
+} // namespace
+
+TimeManager::TimeManager()
+    : moveTimeSec(Config::TIME_LIMIT_SEC), remainingSec(0), incrementSec(0),
+      optimumNs(0), maximumNs(0), startNs(0), running(false), lastBest(),
+      lastScore{0, 0}, scoreKnown{false, false}, iterations(0),
+      instability(0)
+{
+}
+
+void TimeManager::setClock(double remaining, double increment)
+{
+    remainingSec = remaining;
+    incrementSec = std::max(0.0, increment);
+}
+
+void TimeManager::init(int ply)
+{
+    double optimum = 0, maximum = 0;
+
+    if (moveTimeSec > 0)
+    {
+        maximum = moveTimeSec -
+                  std::min(Config::TIME_MARGIN_SEC, moveTimeSec * 0.1);
+        optimum = moveTimeSec * Config::TIME_OPTIMUM_RATIO;
+    }
+    if (remainingSec > 0)
+    {
+        // 残りを残り手数で割った分 + 加算の大半を目安にし、
+        // 難しい局面では残りの 30% まで使ってよい
+        // 残り手数は進むにつれて少なく見積もる (終盤ほど1手に時間を使う)
+        int movesToGo = std::max(10, Config::TIME_MOVES_TO_GO - ply / 4);
+        double left = std::max(0.0, remainingSec - Config::TIME_MARGIN_SEC);
+        double base = left / movesToGo + incrementSec * 0.75;
+        double clockMax =
+            std::min({base * 4, left * 0.3 + incrementSec * 0.75, left});
+        maximum = maximum > 0 ? std::min(maximum, clockMax) : clockMax;
+        optimum = optimum > 0 ? std::min(optimum, base) : base;
+    }
+    if (maximum > 0)
+    {
+        maximum = std::max(maximum, 0.001);
+        optimum = std::min(std::max(optimum, 0.001), maximum);
+    }
+
+    optimumNs = (long long)(optimum * 1e9);
+    maximumNs = (long long)(maximum * 1e9);
+    running = false;
+    lastBest = Move();
+    lastScore[0] = lastScore[1] = 0;
+    scoreKnown[0] = scoreKnown[1] = false;
+    iterations = 0;
+    instability = 0;
+}
+
+void TimeManager::startClock(long long nowNs)
+{
+    startNs = nowNs;
+    running = true;
+}
+
+long long TimeManager::hardDeadline() const
+{
+    if (!running || maximumNs <= 0)
+        return LLONG_MAX;
+    return startNs + maximumNs;
+}
+
+bool TimeManager::iterationDone(int depth, const Move &best,
+                                long long nowNs)
+{
+    // 最善手が変わり続けている間は長く、落ち着いたら短く考える
+    if (iterations > 0)
+    {
+        instability *= 0.5;
+        if (!(best == lastBest))
+            instability += 1.0;
+    }
+    double scale = 0.7 + 0.6 * instability;
+    // 前の反復より評価値が下がったら (読みを深めて悪い手が見えた) 長く考える
+    int parity = depth % 2;
+    long long drop = lastScore[parity] - best.score;
+    if (scoreKnown[parity] && drop > 0)
+        scale *= 1.0 + std::min(1.0, drop / SCORE_SWING);
+
+    iterations++;
+    lastBest = best;
+    lastScore[parity] = best.score;
+    scoreKnown[parity] = true;
+
+    if (!running || optimumNs <= 0)
+        return false;
+    long long budget = std::min((long long)(optimumNs * scale), maximumNs);
+    return nowNs - startNs > budget;
+}
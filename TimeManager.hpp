@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Types.hpp"
+
+// 1手に使う時間の配分
+//   optimum: 反復の終わりにこれを過ぎていたら次の反復に進まない
+//   maximum: これを過ぎたら探索を打ち切る (タイマーが停止フラグを立てる)
+// optimum は反復ごとの最善手の安定性と評価値の変動で伸び縮みする
+// 時刻は steady_clock の ns (AI::nowNs と同じ)
+class TimeManager
+{
+  public:
+    TimeManager();
+
+    // 1手あたりの時間 (秒, 0以下なら無制限)
+    void setMoveTime(double sec) { moveTimeSec = sec; }
+    // 持ち時間: 残り時間と1手ごとの加算 (秒, remaining が0以下なら使わない)
+    // 1手あたりの時間も設定されていれば、そちらを上限にする
+    void setClock(double remainingSec, double incrementSec);
+
+    // 探索の開始: ply 手目を考えるときの配分を決め、安定性の記録を消す
+    void init(int ply);
+    // 時計を動かす (ponder の間は止めておき、ponder hit で動かす)
+    void startClock(long long nowNs);
+    void stopClock() { running = false; }
+    bool isLimited() const { return maximumNs > 0; }
+
+    // 打ち切りの期限 (時計が止まっている/無制限なら LLONG_MAX)
+    long long hardDeadline() const;
+    // 深さ depth の反復が終わるたびに呼ぶ (best.score はその反復の評価値)
+    // 次の反復に進まずに止めるなら true
+    bool iterationDone(int depth, const Move &best, long long nowNs);
+
+    double optimumSec() const { return optimumNs * 1e-9; }
+    double maximumSec() const { return maximumNs * 1e-9; }
+
+  private:
+    double moveTimeSec;
+    double remainingSec;
+    double incrementSec;
+
+    long long optimumNs; // 0 なら無制限
+    long long maximumNs;
+    long long startNs;
+    bool running;
+
+    // 最善手の安定性と評価値の変動
+    // 評価値は深さの偶奇で振れるので、同じ偶奇の反復どうしで比べる
+    Move lastBest;
+    long long lastScore[2];
+    bool scoreKnown[2];
+    int iterations;
+    double instability; // 最善手が変わるたびに増え、反復ごとに半減する
+};
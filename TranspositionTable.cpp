@@ -0,0 +1,114 @@
+#include "TranspositionTable.hpp"
+
+TranspositionTable::TranspositionTable(size_t sizeMB)
+    : bucketCount(0), generation(0)
+{
+    resize(sizeMB);
+}
+
+void TranspositionTable::resize(size_t sizeMB)
+{
+    // バケット数は2のべき乗に切り下げる (インデックスをマスクで求めるため)
+    size_t want = sizeMB * 1024 * 1024 / sizeof(Bucket);
+    size_t count = 1;
+    while (count * 2 <= want)
+        count *= 2;
+
+    if (count != bucketCount)
+    {
+        buckets.reset(new Bucket[count]);
+        bucketCount = count;
+    }
+    clear();
+}
+
+void TranspositionTable::clear()
+{
+    for (size_t i = 0; i < bucketCount; ++i)
+    {
+        for (auto &s : buckets[i].slots)
+        {
+            s.key.store(0, std::memory_order_relaxed);
+            s.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+size_t TranspositionTable::sizeMB() const
+{
+    return bucketCount * sizeof(Bucket) / (1024 * 1024);
+}
+
+uint64_t TranspositionTable::pack(int depth, int score, TTFlag flag,
+                                  uint8_t gen, uint16_t move)
+{
+    return (uint64_t)(uint32_t)score | (uint64_t)(uint8_t)(depth + 1) << 32 |
+           (uint64_t)((uint8_t)flag & 3) << 40 | (uint64_t)gen << 42 |
+           (uint64_t)move << 48;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry &out) const
+{
+    const Bucket &b = buckets[key & (bucketCount - 1)];
+    for (const auto &s : b.slots)
+    {
+        uint64_t data = s.data.load(std::memory_order_relaxed);
+        // key ^ data で保存しているので、書き込み途中の破損エントリは一致しない
+        if ((s.key.load(std::memory_order_relaxed) ^ data) != key ||
+            data == 0)
+            continue;
+
+        out.score = (int32_t)(uint32_t)data;
+        out.depth = depthOf(data);
+        out.flag = (TTFlag)((data >> 40) & 3);
+        uint16_t m = moveOf(data);
+        if (m == NO_MOVE)
+            out.bestMove = Move();
+        else
+            out.bestMove = Move(m / Config::BOARD_SIZE, m % Config::BOARD_SIZE);
+        return true;
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int score,
+                               TTFlag flag, const Move &bestMove)
+{
+    Bucket &b = buckets[key & (bucketCount - 1)];
+    uint16_t move = (bestMove.y < 0)
+                        ? NO_MOVE
+                        : (uint16_t)(bestMove.y * Config::BOARD_SIZE +
+                                     bestMove.x);
+
+    Slot *victim = nullptr;
+    int victimValue = 0;
+    for (auto &s : b.slots)
+    {
+        uint64_t data = s.data.load(std::memory_order_relaxed);
+        if (data != 0 && (s.key.load(std::memory_order_relaxed) ^ data) == key)
+        {
+            // 同一局面: 同世代でより深い結果があれば残す (EXACTは常に上書き)
+            if (genOf(data) == generation && depthOf(data) > depth &&
+                flag != TTFlag::EXACT)
+                return;
+            if (move == NO_MOVE)
+                move = moveOf(data);
+            victim = &s;
+            break;
+        }
+
+        // 置換候補: 浅い & 古い世代ほど優先して捨てる
+        int age = (generation - genOf(data)) & GEN_MASK;
+        int value = (data == 0) ? -1000 : depthOf(data) - age * 4;
+        if (!victim || value < victimValue)
+        {
+            victim = &s;
+            victimValue = value;
+        }
+    }
+
+    uint64_t data = pack(depth, score, flag, generation, move);
+    victim->key.store(key ^ data, std::memory_order_relaxed);
+    victim->data.store(data, std::memory_order_relaxed);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Config.hpp"
+#include "Types.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+struct TTEntry
+{
+    int depth;
+    int score;
+    TTFlag flag;
+    Move bestMove;
+};
+
+// 固定サイズ・キャッシュライン単位のTransposition Table
+// 1エントリ16byte (key ^ data, data) を4つで64byteのバケットにまとめる
+class TranspositionTable
+{
+  public:
+    explicit TranspositionTable(size_t sizeMB = Config::TT_SIZE_MB);
+
+    void resize(size_t sizeMB);
+    void clear();
+    // 探索開始ごとに世代を進める (clearの代わり)
+    void newSearch() { generation = (generation + 1) & GEN_MASK; }
+
+    bool probe(uint64_t key, TTEntry &out) const;
+    void store(uint64_t key, int depth, int score, TTFlag flag,
+               const Move &bestMove);
+
+    size_t sizeMB() const;
+
+  private:
+    static constexpr int BUCKET_SLOTS = 4;
+    static constexpr uint8_t GEN_MASK = 0x3F;
+    static constexpr uint16_t NO_MOVE = 0xFFFF;
+
+    // data: score(32) | depth+1(8) | flag(2) + generation(6) | move(16)
+    // depth+1 で格納するので使用中のスロットの data は0にならない
+    struct Slot
+    {
+        std::atomic<uint64_t> key;
+        std::atomic<uint64_t> data;
+    };
+    struct alignas(64) Bucket
+    {
+        Slot slots[BUCKET_SLOTS];
+    };
+
+    static uint64_t pack(int depth, int score, TTFlag flag, uint8_t gen,
+                         uint16_t move);
+    static int depthOf(uint64_t data) { return ((data >> 32) & 0xFF) - 1; }
+    static uint8_t genOf(uint64_t data) { return (data >> 42) & GEN_MASK; }
+    static uint16_t moveOf(uint64_t data) { return data >> 48; }
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t bucketCount;
+    uint8_t generation;
+};
@@ -1,7 +1,6 @@
 #pragma once
 
 #include <cstdint>
-#include <vector>
 
 enum Player : int8_t
 {
@@ -39,9 +38,14 @@ struct Move
     }
 };
 
-struct MoveResult
+// undo 用の記録 (ヒープ確保なしで Board のスタックに積む)
+struct UndoRecord
 {
-    bool executed;                                   // 非合法手対策
-    std::vector<std::pair<int, int>> capturedStones; // capture復元
-    uint64_t prevHash;                               // Zobrist完全復元
+    uint64_t prevHash;    // Zobrist完全復元
+    int8_t y, x;          // 置いた位置
+    int8_t prevLastY;     // lastMove 復元
+    int8_t prevLastX;     //
+    uint8_t captureDirs;  // bit (dir*2 + 負方向): その方向の2石を捕獲
+    uint8_t prevWinFlags; // 勝利判定キャッシュ復元
+    uint8_t savedLines;   // Board に退避したライン評価の数 (0: 退避なし)
 };
@@ -0,0 +1,12 @@
+#pragma once
+#include "Config.hpp"
+#include <SFML/Graphics.hpp>
+
+// GUI専用の設定 (エンジン単体のビルドにSFMLを持ち込まないよう分離)
+namespace Config
+{
+// UI Colors
+const sf::Color COLOR_BG(222, 184, 135);
+const sf::Color COLOR_LINE(0, 0, 0, 200);
+const sf::Color COLOR_TEXT(20, 20, 20);
+} // namespace Config
@@ -0,0 +1,105 @@
+#include "AI.hpp"
+#include "BenchPositions.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// 探索ベンチマーク: 固定局面を固定深さ・固定ノード数で探索し、
+// ノード数 / NPS / 到達深さ / 最善手のシグネチャを出力する
+//   ./Gomoku_bench [depth] [nodes] [threads] [canonical]
+
+namespace
+{
+// FNV-1a: 最善手とノード数から探索結果の同一性を確認する
+uint64_t mix(uint64_t h, uint64_t v)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        h ^= (v >> (i * 8)) & 0xFF;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+void runSuite(const char *title, int threads, int depth, long long nodes,
+              bool canonical)
+{
+    std::printf("== %s\n", title);
+    std::printf("%-10s %5s %12s %10s %12s %6s\n", "position", "depth",
+                "nodes", "time(ms)", "nps", "best");
+
+    AI ai;
+    ai.setVerbose(false);
+    ai.setThreads(threads);
+    ai.setTimeLimit(0);
+    ai.setNodeLimit(nodes);
+    ai.setCanonicalHash(canonical);
+
+    long long totalNodes = 0;
+    double totalTime = 0;
+    uint64_t signature = 14695981039346656037ull;
+
+    for (const auto &pos : BENCH_POSITIONS)
+    {
+        Board board;
+        for (const auto &m : pos.moves)
+            board.makeMove(m.first, m.second);
+
+        // 局面ごとにTTを空にして結果を再現可能にする
+        ai.newGame();
+        Move best = ai.getBestMove(board, depth);
+        const SearchInfo &info = ai.lastSearchInfo();
+
+        totalNodes += info.nodes;
+        totalTime += info.timeSec;
+        signature = mix(signature, (uint64_t)(best.y * 32 + best.x));
+        signature = mix(signature, (uint64_t)info.nodes);
+
+        std::printf("%-10s %5d %12lld %10.1f %12.0f %3d,%-2d\n", pos.name,
+                    info.depth, info.nodes, info.timeSec * 1000,
+                    info.timeSec > 0 ? info.nodes / info.timeSec : 0.0,
+                    best.x, best.y);
+        for (const auto &it : info.iterations)
+        {
+            std::printf("%10s depth %2d reached at %8.1f ms (%lld nodes, "
+                        "ebf %.2f)\n",
+                        "", it.depth, it.timeSec * 1000, it.nodes, it.ebf);
+            if (!STATS_ENABLED)
+                continue;
+            const SearchStats &st = it.stats;
+            std::printf("%10s   seldepth %2d, tt hit %.1f%%, tt cutoff "
+                        "%.1f%%, first-move cutoff %.1f%%\n",
+                        "", it.selDepth,
+                        st.ttProbes ? 100.0 * st.ttHits / st.ttProbes : 0.0,
+                        st.ttProbes ? 100.0 * st.ttCutoffs / st.ttProbes
+                                    : 0.0,
+                        st.betaCutoffs
+                            ? 100.0 * st.cutoffIndex[0] / st.betaCutoffs
+                            : 0.0);
+        }
+    }
+
+    std::printf("total nodes %lld, time %.1f ms, nps %.0f\n", totalNodes,
+                totalTime * 1000, totalTime > 0 ? totalNodes / totalTime : 0.0);
+    std::printf("signature %016llx\n\n", (unsigned long long)signature);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int depth = (argc > 1) ? std::atoi(argv[1]) : 6;
+    long long nodes = (argc > 2) ? std::atoll(argv[2]) : 200000;
+    int threads = (argc > 3) ? std::atoi(argv[3]) : 1;
+    // 1 なら TT を対称形で共有する
+    bool canonical =
+        (argc > 4) ? std::atoi(argv[4]) != 0 : Config::TT_CANONICAL;
+
+    std::printf("canonical TT: %s\n\n", canonical ? "on" : "off");
+
+    char title[64];
+    std::snprintf(title, sizeof(title), "fixed depth %d", depth);
+    runSuite(title, threads, depth, 0, canonical);
+    std::snprintf(title, sizeof(title), "fixed nodes %lld", nodes);
+    runSuite(title, threads, Config::MAX_DEPTH, nodes, canonical);
+    return 0;
+}
@@ -0,0 +1,219 @@
+#include "AI.hpp"
+#include "GameRecord.hpp"
+#include "OpeningBook.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+// 定跡ファイルの作成
+//   ./Gomoku_book <out.book> [options] [records...]
+//     --plies n      1局の先頭 n 手までを定跡に入れる (既定 12)
+//     --min-games n  n 局以上で打たれた手だけを入れる (既定 2)
+//     --min-score f  打った側の得点率が f 以上の手だけを入れる (既定 0.5)
+//     --selfplay n   自己対局を n 局行って定跡に入れる
+//     --nodes n      自己対局の1手あたりの探索ノード数 (既定 20000)
+//     --maxplies n   自己対局をこの手数で打ち切って引き分けにする (既定 120)
+//     --save file    自己対局の棋譜を (結果付きで) 書き出す
+//     records        棋譜ファイル (GameRecord 形式, 1行1局)
+// 手の重みは打った側から見た対局の結果 (勝ち 2, 引き分け 1, 負け 0)
+// 棋譜に結果がなければ最後まで並べて判定し、決着していなければ引き分け
+
+namespace
+{
+// 着手列を最後まで並べて、黒から見た得点 (勝ち 2, 引き分け 1, 負け 0)
+int replayScore(const std::vector<std::pair<int, int>> &moves)
+{
+    Board board;
+    for (const auto &m : moves)
+    {
+        int y = m.first, x = m.second;
+        if (!board.isValid(y, x) || board.grid[y][x] != NONE ||
+            (board.currentTurn == BLACK && board.isDoubleThree(y, x)))
+            break;
+        Player me = board.currentTurn;
+        board.makeMove(y, x);
+        if (board.checkWin(me))
+            return (me == BLACK) ? 2 : 0;
+    }
+    return 1;
+}
+
+// 対局の先頭 plies 手を (正規化キー, 正規化した手) で追加する
+// blackScore: 黒から見た対局の得点 (白の手の重みは 2 - blackScore)
+int addGame(const std::vector<std::pair<int, int>> &moves, int plies,
+            int blackScore, std::vector<BookEntry> &entries)
+{
+    Board board;
+    board.setSymmetryHashing(true); // 全局面で正規化キーを引く
+    int added = 0;
+    for (const auto &m : moves)
+    {
+        if (added >= plies)
+            break;
+        int y = m.first, x = m.second;
+        if (!board.isValid(y, x) || board.grid[y][x] != NONE ||
+            (board.currentTurn == BLACK && board.isDoubleThree(y, x)))
+            break;
+
+        int sym;
+        BookEntry e = {};
+        e.key = OpeningBook::canonicalKey(board, sym);
+        e.move = OpeningBook::canonicalMove(board, y, x);
+        e.weight = (uint16_t)(board.currentTurn == BLACK ? blackScore
+                                                         : 2 - blackScore);
+        e.games = 1;
+        entries.push_back(e);
+        added++;
+
+        Player me = board.currentTurn;
+        board.makeMove(y, x);
+        if (board.checkWin(me))
+            break;
+    }
+    return added;
+}
+
+// 中央付近にランダムな2手を置いてから、AI同士で決着か maxPlies 手まで打つ
+std::vector<std::pair<int, int>> selfPlayGame(AI &ai, std::mt19937 &rng,
+                                              int maxPlies)
+{
+    const int c = Config::BOARD_SIZE / 2;
+    std::vector<std::pair<int, int>> moves = {{c, c}};
+    Board board;
+    board.makeMove(c, c);
+
+    std::uniform_int_distribution<int> near(-2, 2);
+    while (moves.size() < 3)
+    {
+        int y = c + near(rng), x = c + near(rng);
+        if (board.grid[y][x] != NONE ||
+            (board.currentTurn == BLACK && board.isDoubleThree(y, x)))
+            continue;
+        board.makeMove(y, x);
+        moves.push_back({y, x});
+    }
+
+    ai.newGame();
+    while ((int)moves.size() < maxPlies)
+    {
+        Player me = board.currentTurn;
+        Move m = ai.getBestMove(board);
+        if (m.y < 0 || !board.makeMove(m.y, m.x))
+            break;
+        moves.push_back({m.y, m.x});
+        if (board.checkWin(me))
+            break;
+    }
+    return moves;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr,
+                     "usage: %s <out.book> [--plies n] [--min-games n] "
+                     "[--min-score f] [--selfplay n] [--nodes n] "
+                     "[--maxplies n] [--save file] [records...]\n",
+                     argv[0]);
+        return 1;
+    }
+
+    std::string out = argv[1];
+    int plies = 12;
+    int minGames = 2;
+    double minScore = 0.5;
+    int selfPlay = 0;
+    long long nodes = 20000;
+    int maxPlies = 120;
+    std::string savePath;
+    std::vector<std::string> records;
+    for (int i = 2; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--plies") && hasValue)
+            plies = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--min-games") && hasValue)
+            minGames = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--min-score") && hasValue)
+            minScore = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--selfplay") && hasValue)
+            selfPlay = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--nodes") && hasValue)
+            nodes = std::atoll(argv[++i]);
+        else if (!std::strcmp(argv[i], "--maxplies") && hasValue)
+            maxPlies = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--save") && hasValue)
+            savePath = argv[++i];
+        else
+            records.push_back(argv[i]);
+    }
+
+    std::vector<BookEntry> entries;
+    int games = 0;
+
+    for (const auto &path : records)
+    {
+        std::ifstream in(path);
+        if (!in)
+        {
+            std::fprintf(stderr, "cannot open %s\n", path.c_str());
+            return 1;
+        }
+        std::string line;
+        while (std::getline(in, line))
+        {
+            auto moves = GameRecord::parse(line);
+            int blackScore;
+            if (!GameRecord::parseResult(line, blackScore))
+                blackScore = replayScore(moves);
+            if (addGame(moves, plies, blackScore, entries) > 0)
+                games++;
+        }
+    }
+
+    if (selfPlay > 0)
+    {
+        AI ai;
+        ai.setVerbose(false);
+        ai.setTimeLimit(0);
+        ai.setNodeLimit(nodes);
+        std::mt19937 rng(12345);
+        std::ofstream save;
+        if (!savePath.empty())
+            save.open(savePath);
+
+        for (int g = 0; g < selfPlay; ++g)
+        {
+            auto moves = selfPlayGame(ai, rng, maxPlies);
+            int blackScore = replayScore(moves);
+            addGame(moves, plies, blackScore, entries);
+            games++;
+            if (save)
+                save << GameRecord::format(moves) << ' '
+                     << (blackScore == 2   ? "1-0"
+                         : blackScore == 0 ? "0-1"
+                                           : "1/2-1/2")
+                     << '\n';
+            std::fprintf(stderr, "\rself-play %d/%d", g + 1, selfPlay);
+        }
+        std::fprintf(stderr, "\n");
+    }
+
+    if (!OpeningBook::write(out, entries, (uint32_t)std::max(1, minGames),
+                            minScore))
+    {
+        std::fprintf(stderr, "cannot write %s\n", out.c_str());
+        return 1;
+    }
+
+    OpeningBook book;
+    book.open(out);
+    std::printf("%d games, %zu positions -> %s (%zu entries)\n", games,
+                entries.size(), out.c_str(), book.size());
+    return 0;
+}
@@ -0,0 +1,11 @@
+#include "EngineProtocol.hpp"
+#include <iostream>
+
+// GUIなしのエンジン: 標準入出力でコマンドをやり取りする
+int main()
+{
+    std::ios::sync_with_stdio(false);
+    EngineProtocol protocol(std::cin, std::cout);
+    protocol.run();
+    return 0;
+}
@@ -0,0 +1,329 @@
+#include "BenchPositions.hpp"
+#include "Board.hpp"
+#include "Pattern.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// perft: 合法手 (三三禁を除く全空点) を深さNまで全列挙し、
+// 末端局面数・捕獲手・勝ち手を既知の値と照合する。
+// make/undo 1組あたりの速度も計測する。
+//   ./Gomoku_perft [depth] [--verify] [--canonical]
+// --verify: 全ノードで差分更新している状態を盤面から再計算して照合し、
+//           undo 後に局面が完全に元へ戻っているかも確認する (低速)
+// --canonical: 対称形のハッシュも差分更新する (TT_CANONICAL の探索と同じ)
+
+namespace
+{
+struct PerftCount
+{
+    long long leaves;
+    long long captures; // 末端の手のうち捕獲を伴うもの
+    long long wins;     // 末端の手のうち勝ちになるもの
+};
+
+struct Expected
+{
+    const char *name;
+    int depth;
+    PerftCount count;
+};
+
+// 変更前の実装 (盤面を1マスずつ走査する版) で求めた値
+const Expected EXPECTED[] = {
+    {"empty", 1, {361, 0, 0}},
+    {"empty", 2, {129960, 0, 0}},
+    {"empty", 3, {46655640, 0, 0}},
+    {"opening-1", 1, {355, 0, 0}},
+    {"opening-1", 2, {125670, 3, 0}},
+    {"opening-1", 3, {44361516, 734, 0}},
+    {"opening-2", 1, {352, 0, 0}},
+    {"opening-2", 2, {123552, 358, 0}},
+    {"opening-2", 3, {43243916, 2134, 0}},
+    {"middle-1", 1, {342, 2, 0}},
+    {"middle-1", 2, {116968, 13, 0}},
+    {"middle-1", 3, {39773586, 237704, 682}},
+    {"middle-2", 1, {339, 1, 0}},
+    {"middle-2", 2, {114584, 354, 674}},
+    {"middle-2", 3, {38387740, 117646, 2002}},
+    {"capture-1", 1, {341, 0, 0}},
+    {"capture-1", 2, {115940, 690, 340}},
+    {"capture-1", 3, {39188118, 3477, 2689}},
+    {"capture-2", 1, {340, 0, 0}},
+    {"capture-2", 2, {115600, 11, 0}},
+    {"capture-2", 3, {39074524, 6467, 0}},
+    {"capture-3", 1, {333, 1, 0}},
+    {"capture-3", 2, {110558, 1014, 0}},
+    {"capture-3", 3, {36597069, 118202, 1665}},
+};
+
+long long makeUndoPairs = 0;
+bool verifyFailed = false;
+
+// Board::scoreLine の照合用: ラインを1マスずつ見て、相手の石・盤外・
+// 3つ続く空きで石のまとまりに分け、まとまりごとの一番強い形を合計する
+int referenceLineScore(uint32_t own, uint32_t empty)
+{
+    int score = 0;
+    int pos = 0;
+    while (pos < Config::BOARD_SIZE)
+    {
+        if (!((own >> pos) & 1u))
+        {
+            pos++;
+            continue;
+        }
+        uint32_t seg = 0;
+        int emptyRun = 0;
+        for (; pos < Config::BOARD_SIZE; ++pos)
+        {
+            if ((own >> pos) & 1u)
+            {
+                seg |= 1u << pos;
+                emptyRun = 0;
+            }
+            else if (!((empty >> pos) & 1u) || ++emptyRun == 3)
+                break;
+        }
+        int best = Pattern::NONE;
+        for (int i = 0; i < Config::BOARD_SIZE; ++i)
+        {
+            if ((seg >> i) & 1u)
+                best = std::max<int>(
+                    best, Pattern::classify(seg, empty | (own & ~seg), i));
+        }
+        score += Pattern::SCORE[best];
+    }
+    return score;
+}
+
+// 差分更新している値を盤面から計算し直して照合する
+bool consistent(const Board &b)
+{
+    uint64_t hash = (b.currentTurn == WHITE) ? zobrist.turnHash : 0;
+    uint64_t symHash[Symmetry::COUNT];
+    for (uint64_t &h : symHash)
+        h = hash;
+    uint32_t lines[3][Board::LINE_COUNT] = {};
+    uint8_t near[Config::BOARD_SIZE][Config::BOARD_SIZE] = {};
+    for (int y = 0; y < Config::BOARD_SIZE; ++y)
+    {
+        for (int x = 0; x < Config::BOARD_SIZE; ++x)
+        {
+            Player p = b.grid[y][x];
+            if (p == NONE)
+                continue;
+            hash ^= zobrist.table[y][x][p];
+            for (int s = 0; s < Symmetry::COUNT; ++s)
+            {
+                int ty, tx;
+                Symmetry::transform(s, y, x, ty, tx);
+                symHash[s] ^= zobrist.table[ty][tx][p];
+            }
+            for (int d = 0; d < 4; ++d)
+                lines[p][Board::lineIndex(d, y, x)] |=
+                    1u << Board::linePos(d, y, x);
+            for (int ny = y - Board::NEAR_RANGE; ny <= y + Board::NEAR_RANGE;
+                 ++ny)
+            {
+                for (int nx = x - Board::NEAR_RANGE;
+                     nx <= x + Board::NEAR_RANGE; ++nx)
+                {
+                    if (b.isValid(ny, nx))
+                        near[ny][nx]++;
+                }
+            }
+        }
+    }
+    // 対称形のハッシュは差分更新しているときだけ照合する
+    if (hash != b.hash ||
+        (b.symmetryHashing &&
+         std::memcmp(symHash, b.symHash, sizeof(symHash)) != 0) ||
+        std::memcmp(lines, b.lines, sizeof(lines)) != 0 ||
+        std::memcmp(near, b.nearCount, sizeof(near)) != 0)
+        return false;
+
+    // 候補手集合 = 近傍に石がある空点
+    int candidates = 0;
+    bool candidateOk = true;
+    b.forEachCandidate(
+        [&](int y, int x)
+        {
+            candidates++;
+            candidateOk &= b.grid[y][x] == NONE && near[y][x] > 0;
+        });
+    for (int y = 0; y < Config::BOARD_SIZE; ++y)
+    {
+        for (int x = 0; x < Config::BOARD_SIZE; ++x)
+            candidates -= (b.grid[y][x] == NONE && near[y][x] > 0);
+    }
+    if (!candidateOk || candidates != 0)
+        return false;
+
+    for (int p = BLACK; p <= WHITE; ++p)
+    {
+        int score = 0;
+        bool five = false;
+        for (int i = 0; i < Board::LINE_COUNT; ++i)
+        {
+            uint32_t m = lines[p][i];
+            uint32_t empty =
+                BoardLines::VALID[i] & ~(lines[BLACK][i] | lines[WHITE][i]);
+            score += referenceLineScore(m, empty);
+            five |= (m & (m >> 1) & (m >> 2) & (m >> 3) & (m >> 4)) != 0;
+        }
+        bool win = five || b.captures[p] >= 10;
+        if (score != b.patternScore[p] || win != ((b.winFlags >> p) & 1))
+            return false;
+    }
+    return true;
+}
+
+// undo で戻るべき状態
+bool sameState(const Board &a, const Board &b)
+{
+    return std::memcmp(a.grid, b.grid, sizeof(a.grid)) == 0 &&
+           std::memcmp(a.lines, b.lines, sizeof(a.lines)) == 0 &&
+           std::memcmp(a.lineScore, b.lineScore, sizeof(a.lineScore)) == 0 &&
+           std::memcmp(a.nearMask, b.nearMask, sizeof(a.nearMask)) == 0 &&
+           std::memcmp(a.stoneMask, b.stoneMask, sizeof(a.stoneMask)) == 0 &&
+           a.captures[BLACK] == b.captures[BLACK] &&
+           a.captures[WHITE] == b.captures[WHITE] && a.hash == b.hash &&
+           (!a.symmetryHashing ||
+            std::memcmp(a.symHash, b.symHash, sizeof(a.symHash)) == 0) &&
+           a.currentTurn == b.currentTurn && a.winFlags == b.winFlags &&
+           a.lastMove == b.lastMove && a.moveCount() == b.moveCount() &&
+           a.patternScore[BLACK] == b.patternScore[BLACK] &&
+           a.patternScore[WHITE] == b.patternScore[WHITE];
+}
+
+void perft(Board &b, int depth, bool verify, PerftCount &c)
+{
+    if (verify && !consistent(b))
+        verifyFailed = true;
+
+    Board before;
+    if (verify)
+        before = b;
+
+    for (int y = 0; y < Config::BOARD_SIZE; ++y)
+    {
+        for (int x = 0; x < Config::BOARD_SIZE; ++x)
+        {
+            if (b.grid[y][x] != NONE || b.isDoubleThree(y, x))
+                continue;
+
+            Player me = b.currentTurn;
+            int capturesBefore = b.captures[me];
+            b.makeMove(y, x);
+            if (depth == 1)
+            {
+                c.leaves++;
+                if (b.captures[me] != capturesBefore)
+                    c.captures++;
+                if (b.checkWin(me))
+                    c.wins++;
+                if (verify && !consistent(b))
+                    verifyFailed = true;
+            }
+            else if (!b.checkWin(me)) // 決着した局面は展開しない
+            {
+                perft(b, depth - 1, verify, c);
+            }
+            b.undoMove();
+            makeUndoPairs++;
+
+            if (verify && !sameState(before, b))
+                verifyFailed = true;
+        }
+    }
+}
+
+const Expected *findExpected(const char *name, int depth)
+{
+    for (const auto &e : EXPECTED)
+    {
+        if (e.depth == depth && std::strcmp(e.name, name) == 0)
+            return &e;
+    }
+    return nullptr;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int maxDepth = 2;
+    bool verify = false;
+    bool canonical = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--verify")
+            verify = true;
+        else if (std::string(argv[i]) == "--canonical")
+            canonical = true;
+        else
+            maxDepth = std::atoi(argv[i]);
+    }
+
+    std::vector<BenchPosition> positions = {{"empty", {}}};
+    positions.insert(positions.end(), BENCH_POSITIONS.begin(),
+                     BENCH_POSITIONS.end());
+
+    std::printf("%-10s %5s %12s %10s %8s %10s %s\n", "position", "depth",
+                "leaves", "captures", "wins", "time(ms)", "result");
+
+    int failures = 0;
+    long long totalPairs = 0;
+    double totalTime = 0;
+
+    for (const auto &pos : positions)
+    {
+        for (int depth = 1; depth <= maxDepth; ++depth)
+        {
+            Board board;
+            board.setSymmetryHashing(canonical);
+            for (const auto &m : pos.moves)
+                board.makeMove(m.first, m.second);
+
+            PerftCount c = {0, 0, 0};
+            makeUndoPairs = 0;
+            verifyFailed = false;
+
+            auto start = std::chrono::steady_clock::now();
+            perft(board, depth, verify, c);
+            std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start;
+
+            totalPairs += makeUndoPairs;
+            totalTime += elapsed.count();
+
+            const char *result = "-";
+            const Expected *e = findExpected(pos.name, depth);
+            bool countMismatch = e && (e->count.leaves != c.leaves ||
+                                       e->count.captures != c.captures ||
+                                       e->count.wins != c.wins);
+            if (verifyFailed)
+                result = "STATE MISMATCH";
+            else if (countMismatch)
+                result = "COUNT MISMATCH";
+            else if (e)
+                result = "ok";
+            if (verifyFailed || countMismatch)
+                failures++;
+
+            std::printf("%-10s %5d %12lld %10lld %8lld %10.1f %s\n", pos.name,
+                        depth, c.leaves, c.captures, c.wins,
+                        elapsed.count() * 1000, result);
+        }
+    }
+
+    std::printf("make/undo pairs %lld, time %.1f ms, %.0f pairs/s\n",
+                totalPairs, totalTime * 1000,
+                totalTime > 0 ? totalPairs / totalTime : 0.0);
+    if (failures)
+        std::printf("%d FAILURE(S)\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,509 @@
+#include "AI.hpp"
+#include "GameRecord.hpp"
+#include "OpeningBook.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 自己対局によるエンジン同士の比較 (探索・評価の変更前後の確認用)
+//   ./Gomoku_selfplay [options]
+//     --a spec / --b spec  エンジンの設定 (例: "nodes=20000,threads=1")
+//                          キー: nodes time clock inc depth threads hash
+//                          canonical lmr (clock/inc は持ち時間と加算の秒数)
+//                          nodes の既定は 20000 だが、time か clock を
+//                          指定したら既定は 0 (ノード数の制限なし)
+//     --games n            対局数 (既定 200, 開局ごとに先後を入れ替えた2局)
+//     --concurrency n      同時に進める対局数 (既定 コア数)
+//     --book file          開局を定跡から重みに比例して選ぶ
+//     --opening n          開局の手数 (既定 4, 定跡にない分は中央付近に置く)
+//     --maxplies n         この手数で引き分け (既定 200)
+//     --sprt elo0 elo1     SPRT (alpha = beta = 0.05) で結論が出たら打ち切る
+//     --out file           棋譜を1行1局で書き出す
+//     --seed n             開局の乱数の種
+// 棋譜の行は GameRecord 形式の着手列に、結果 (黒-白: 1-0 / 0-1 / 1/2-1/2) と
+// 黒番のエンジン (A-B なら A が黒) を続けたもの (GameRecord::parse で読める)
+
+namespace
+{
+struct EngineSpec
+{
+    static constexpr long long DEFAULT_NODES = 20000;
+
+    long long nodes = -1; // 負なら未指定 (resolveNodes で決める)
+    double timeSec = 0;
+    double clockSec = 0; // 持ち時間 (0 なら使わない, 切れたら負け)
+    double incSec = 0;
+    int depth = Config::MAX_DEPTH;
+    int threads = 1;
+    size_t hashMB = 16;
+    bool canonical = Config::TT_CANONICAL;
+    bool lmr = true;
+};
+
+struct Options
+{
+    EngineSpec spec[2];
+    int games = 200;
+    int concurrency = 1;
+    std::string bookPath;
+    int openingPlies = 4;
+    int maxPlies = 200;
+    bool sprt = false;
+    double elo0 = 0, elo1 = 5;
+    std::string outPath;
+    unsigned seed = 1;
+};
+
+// "key=value,key=value" を読む (知らないキーなら false)
+bool parseSpec(const char *text, EngineSpec &spec)
+{
+    std::string s = text;
+    size_t i = 0;
+    while (i < s.size())
+    {
+        size_t end = s.find(',', i);
+        if (end == std::string::npos)
+            end = s.size();
+        std::string item = s.substr(i, end - i);
+        i = end + 1;
+
+        size_t eq = item.find('=');
+        if (eq == std::string::npos)
+            return false;
+        std::string key = item.substr(0, eq);
+        const char *value = item.c_str() + eq + 1;
+        if (key == "nodes")
+            spec.nodes = std::atoll(value);
+        else if (key == "time")
+            spec.timeSec = std::atof(value);
+        else if (key == "clock")
+            spec.clockSec = std::atof(value);
+        else if (key == "inc")
+            spec.incSec = std::atof(value);
+        else if (key == "depth")
+            spec.depth = std::atoi(value);
+        else if (key == "threads")
+            spec.threads = std::atoi(value);
+        else if (key == "hash")
+            spec.hashMB = std::atoi(value);
+        else if (key == "canonical")
+            spec.canonical = std::atoi(value) != 0;
+        else if (key == "lmr")
+            spec.lmr = std::atoi(value) != 0;
+        else
+            return false;
+    }
+    return true;
+}
+
+// nodes の指定がなければ、時間制限のある設定はノード数で制限しない
+// (時間での比較がノード数の上限で決まってしまわないように)
+void resolveNodes(EngineSpec &spec)
+{
+    if (spec.nodes >= 0)
+        return;
+    bool timed = spec.timeSec > 0 || spec.clockSec > 0;
+    spec.nodes = timed ? 0 : EngineSpec::DEFAULT_NODES;
+}
+
+void configure(AI &ai, const EngineSpec &spec)
+{
+    ai.setVerbose(false);
+    ai.setHashSize(spec.hashMB);
+    ai.setThreads(spec.threads);
+    ai.setTimeLimit(spec.timeSec);
+    ai.setNodeLimit(spec.nodes);
+    ai.setCanonicalHash(spec.canonical);
+    ai.setLateMoveReductions(spec.lmr);
+}
+
+bool isLegal(Board &board, int y, int x)
+{
+    return board.isValid(y, x) && board.grid[y][x] == NONE &&
+           !(board.currentTurn == BLACK && board.isDoubleThree(y, x));
+}
+
+// 開局: 定跡から重みに比例して選び、なくなったら中央付近にランダムに置く
+std::vector<std::pair<int, int>> makeOpening(const Options &opt,
+                                             const OpeningBook &book,
+                                             unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> near(-2, 2);
+    const int c = Config::BOARD_SIZE / 2;
+
+    Board board;
+    std::vector<std::pair<int, int>> moves;
+    while ((int)moves.size() < opt.openingPlies)
+    {
+        Move m = book.probe(board, &rng);
+        int y = m.y, x = m.x;
+        if (y < 0)
+        {
+            if (moves.empty())
+                y = c, x = c;
+            else
+                y = c + near(rng), x = c + near(rng);
+            if (!isLegal(board, y, x))
+                continue;
+        }
+        Player me = board.currentTurn;
+        board.makeMove(y, x);
+        moves.push_back({y, x});
+        // 開局で勝負がつく局面は使わない (ほぼ起きない)
+        if (board.checkWin(me))
+            return makeOpening(opt, book, seed * 2654435761u + 1);
+    }
+    return moves;
+}
+
+// エンジンごとの探索の集計
+struct SearchTotals
+{
+    long long moves = 0; // 探索した手 (定跡・VCF で決めた手は除く)
+    long long nodes = 0;
+    double timeSec = 0;
+    long long depthSum = 0;
+    int timeLosses = 0;
+};
+
+struct GameResult
+{
+    std::vector<std::pair<int, int>> moves;
+    int winner; // 0: A, 1: B, -1: 引き分け
+};
+
+// engines[0] が黒で打つ
+GameResult playGame(AI *engines[2], const int engineIds[2],
+                    const EngineSpec *specs[2],
+                    const std::vector<std::pair<int, int>> &opening,
+                    int maxPlies, SearchTotals totals[2])
+{
+    GameResult result = {opening, -1};
+    double clock[2] = {specs[0]->clockSec, specs[1]->clockSec};
+    Board board;
+    for (const auto &m : opening)
+        board.makeMove(m.first, m.second);
+    engines[0]->newGame();
+    engines[1]->newGame();
+
+    while ((int)result.moves.size() < maxPlies)
+    {
+        int side = board.currentTurn == BLACK ? 0 : 1;
+        Player me = board.currentTurn;
+        AI &ai = *engines[side];
+        const EngineSpec &spec = *specs[side];
+        if (spec.clockSec > 0)
+            ai.setClock(clock[side], spec.incSec);
+        auto start = std::chrono::steady_clock::now();
+        Move m = ai.getBestMove(board, spec.depth);
+        if (spec.clockSec > 0)
+        {
+            std::chrono::duration<double> used =
+                std::chrono::steady_clock::now() - start;
+            clock[side] -= used.count();
+            if (clock[side] < 0)
+            {
+                result.winner = engineIds[1 - side];
+                totals[engineIds[side]].timeLosses++;
+                break;
+            }
+            clock[side] += spec.incSec;
+        }
+        // 打てる手がない (または履歴が一杯) なら引き分け
+        if (m.y < 0 || !board.makeMove(m.y, m.x))
+            break;
+        result.moves.push_back({m.y, m.x});
+
+        const SearchInfo &info = ai.lastSearchInfo();
+        if (info.nodes > 0)
+        {
+            SearchTotals &t = totals[engineIds[side]];
+            t.moves++;
+            t.nodes += info.nodes;
+            t.timeSec += info.timeSec;
+            t.depthSum += info.depth;
+        }
+
+        if (board.checkWin(me))
+        {
+            result.winner = engineIds[side];
+            break;
+        }
+    }
+    return result;
+}
+
+// A から見た成績
+struct Score
+{
+    int wins = 0, draws = 0, losses = 0;
+
+    int games() const { return wins + draws + losses; }
+    double ratio() const { return (wins + draws * 0.5) / games(); }
+    // 1局あたりの得点の分散
+    double variance() const
+    {
+        double p = ratio();
+        return (wins * (1 - p) * (1 - p) + draws * (0.5 - p) * (0.5 - p) +
+                losses * p * p) /
+               games();
+    }
+};
+
+double eloFromScore(double p)
+{
+    p = std::min(std::max(p, 1e-6), 1 - 1e-6);
+    return -400.0 * std::log10(1.0 / p - 1.0);
+}
+
+double scoreFromElo(double elo)
+{
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+// Elo 差と 95% 信頼区間の半幅
+void eloInterval(const Score &s, double &elo, double &margin)
+{
+    double p = s.ratio();
+    double se = std::sqrt(s.variance() / s.games());
+    elo = eloFromScore(p);
+    margin = (eloFromScore(p + 1.96 * se) - eloFromScore(p - 1.96 * se)) / 2;
+}
+
+// 正規近似による SPRT の対数尤度比
+double sprtLLR(const Score &s, double elo0, double elo1)
+{
+    double var = s.variance();
+    if (s.wins == 0 || s.losses == 0 || var <= 0)
+        return 0;
+    double s0 = scoreFromElo(elo0), s1 = scoreFromElo(elo1);
+    return (s1 - s0) * (2 * s.ratio() - s0 - s1) * s.games() / (2 * var);
+}
+
+void printSpec(const char *name, const EngineSpec &spec,
+               const SearchTotals &t)
+{
+    std::printf("%s: nodes=%lld time=%.2f clock=%.1f+%.2f depth=%d "
+                "threads=%d hash=%zu canonical=%d lmr=%d\n",
+                name, spec.nodes, spec.timeSec, spec.clockSec, spec.incSec,
+                spec.depth, spec.threads, spec.hashMB,
+                spec.canonical ? 1 : 0, spec.lmr ? 1 : 0);
+    if (t.timeLosses > 0)
+        std::printf("   lost %d games on time\n", t.timeLosses);
+    if (t.moves > 0)
+    {
+        std::printf("   searched %lld moves, avg depth %.2f, avg nodes %.0f, "
+                    "nps %.0f\n",
+                    t.moves, (double)t.depthSum / t.moves,
+                    (double)t.nodes / t.moves,
+                    t.timeSec > 0 ? t.nodes / t.timeSec : 0.0);
+    }
+}
+
+void usage(const char *prog)
+{
+    std::fprintf(stderr,
+                 "usage: %s [--a spec] [--b spec] [--games n] "
+                 "[--concurrency n] [--book file] [--opening n] "
+                 "[--maxplies n] [--sprt elo0 elo1] [--out file] "
+                 "[--seed n]\n"
+                 "  spec: nodes=N,time=SEC,clock=SEC,inc=SEC,depth=N,"
+                 "threads=N,hash=MB,canonical=0|1,lmr=0|1\n"
+                 "  nodes defaults to %lld, or to 0 (no node limit) when "
+                 "time or clock is set\n",
+                 prog, EngineSpec::DEFAULT_NODES);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    opt.concurrency = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--a") && hasValue)
+        {
+            if (!parseSpec(argv[++i], opt.spec[0]))
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (!std::strcmp(argv[i], "--b") && hasValue)
+        {
+            if (!parseSpec(argv[++i], opt.spec[1]))
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (!std::strcmp(argv[i], "--games") && hasValue)
+            opt.games = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--concurrency") && hasValue)
+            opt.concurrency = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--book") && hasValue)
+            opt.bookPath = argv[++i];
+        else if (!std::strcmp(argv[i], "--opening") && hasValue)
+            opt.openingPlies = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--maxplies") && hasValue)
+            opt.maxPlies = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--sprt") && i + 2 < argc)
+        {
+            opt.sprt = true;
+            opt.elo0 = std::atof(argv[++i]);
+            opt.elo1 = std::atof(argv[++i]);
+        }
+        else if (!std::strcmp(argv[i], "--out") && hasValue)
+            opt.outPath = argv[++i];
+        else if (!std::strcmp(argv[i], "--seed") && hasValue)
+            opt.seed = (unsigned)std::atoi(argv[++i]);
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    for (auto &spec : opt.spec)
+        resolveNodes(spec);
+    // 先後を入れ替えた2局を1組にする
+    opt.games += opt.games % 2;
+
+    OpeningBook book;
+    if (!opt.bookPath.empty() && !book.open(opt.bookPath))
+    {
+        std::fprintf(stderr, "cannot open book %s\n", opt.bookPath.c_str());
+        return 1;
+    }
+    std::ofstream out;
+    if (!opt.outPath.empty())
+    {
+        out.open(opt.outPath);
+        if (!out)
+        {
+            std::fprintf(stderr, "cannot open %s\n", opt.outPath.c_str());
+            return 1;
+        }
+    }
+
+    // SPRT の判定境界
+    const double alpha = 0.05, beta = 0.05;
+    const double lower = std::log(beta / (1 - alpha));
+    const double upper = std::log((1 - beta) / alpha);
+
+    std::atomic<int> nextGame(0);
+    std::atomic<bool> stop(false);
+    std::mutex resultMutex; // 以下の集計と棋譜の書き出し
+    Score score;
+    SearchTotals totals[2];
+    double llr = 0;
+
+    auto worker = [&]()
+    {
+        AI engineA, engineB;
+        configure(engineA, opt.spec[0]);
+        configure(engineB, opt.spec[1]);
+
+        int g;
+        while (!stop && (g = nextGame++) < opt.games)
+        {
+            auto opening = makeOpening(opt, book, opt.seed + g / 2);
+            // 偶数番は A が黒、奇数番は B が黒
+            bool aBlack = g % 2 == 0;
+            AI *engines[2] = {aBlack ? &engineA : &engineB,
+                              aBlack ? &engineB : &engineA};
+            int ids[2] = {aBlack ? 0 : 1, aBlack ? 1 : 0};
+            const EngineSpec *specs[2] = {&opt.spec[ids[0]],
+                                          &opt.spec[ids[1]]};
+            SearchTotals local[2];
+            GameResult r =
+                playGame(engines, ids, specs, opening, opt.maxPlies, local);
+
+            std::lock_guard<std::mutex> lock(resultMutex);
+            for (int i = 0; i < 2; ++i)
+            {
+                totals[i].moves += local[i].moves;
+                totals[i].nodes += local[i].nodes;
+                totals[i].timeSec += local[i].timeSec;
+                totals[i].depthSum += local[i].depthSum;
+                totals[i].timeLosses += local[i].timeLosses;
+            }
+            if (r.winner == 0)
+                score.wins++;
+            else if (r.winner == 1)
+                score.losses++;
+            else
+                score.draws++;
+
+            if (out)
+            {
+                const char *res = r.winner < 0                 ? "1/2-1/2"
+                                  : (r.winner == 0) == aBlack ? "1-0"
+                                                               : "0-1";
+                out << GameRecord::format(r.moves) << ' ' << res << ' '
+                    << (aBlack ? "A-B" : "B-A") << '\n'
+                    << std::flush;
+            }
+
+            double elo, margin;
+            eloInterval(score, elo, margin);
+            std::fprintf(stderr,
+                         "\rgame %d/%d  +%d =%d -%d  elo %+.1f +/- %.1f",
+                         score.games(), opt.games, score.wins, score.draws,
+                         score.losses, elo, margin);
+            if (opt.sprt)
+            {
+                llr = sprtLLR(score, opt.elo0, opt.elo1);
+                std::fprintf(stderr, "  llr %.2f [%.2f, %.2f]", llr, lower,
+                             upper);
+                if (llr <= lower || llr >= upper)
+                    stop = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < opt.concurrency; ++i)
+        workers.emplace_back(worker);
+    for (auto &th : workers)
+        th.join();
+    std::fprintf(stderr, "\n");
+
+    printSpec("A", opt.spec[0], totals[0]);
+    printSpec("B", opt.spec[1], totals[1]);
+    if (score.games() == 0)
+        return 0;
+
+    double elo, margin;
+    eloInterval(score, elo, margin);
+    double los = 0.5;
+    if (score.wins + score.losses > 0)
+    {
+        double n = score.wins + score.losses;
+        los = 0.5 * (1 + std::erf((score.wins - score.losses) /
+                                  std::sqrt(2.0 * n)));
+    }
+    std::printf("games %d: A +%d =%d -%d  score %.1f%%\n", score.games(),
+                score.wins, score.draws, score.losses, score.ratio() * 100);
+    std::printf("elo %+.1f +/- %.1f (95%%), LOS %.1f%%\n", elo, margin,
+                los * 100);
+    if (opt.sprt)
+    {
+        const char *verdict = llr >= upper   ? "H1 accepted (A is stronger)"
+                              : llr <= lower ? "H0 accepted"
+                                             : "inconclusive";
+        std::printf("sprt [%.1f, %.1f]: llr %.2f [%.2f, %.2f] %s\n", opt.elo0,
+                    opt.elo1, llr, lower, upper, verdict);
+    }
+    return 0;
+}